@@ -0,0 +1,41 @@
+/**
+ * @file event_loop.h
+ * @brief Blocking wait for the OLSR main loop
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ *
+ * The main loop sleeps until its next deadline (HELLO, TC, retry or a
+ * soft-state timer) or until another thread hands it work, instead of
+ * polling. On Linux this is an epoll set holding a timerfd for the
+ * deadline and an eventfd for wake-ups; elsewhere it falls back to
+ * short sleeps that still honour both. With the virtual clock the wait
+ * does not block at all: the clock is fast-forwarded to the deadline.
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include "olsr_clock.h"
+
+/**
+ * @brief Set up the wait primitives
+ * @return 0 on success, -1 if only the sleep fallback is available
+ */
+int event_loop_init(void);
+
+/**
+ * @brief Block until a deadline passes or the loop is woken
+ * @param deadline Absolute time to wake at (olsr_clock_now() time base)
+ * @return 1 if woken by event_loop_wake(), 0 if the deadline passed
+ */
+int event_loop_wait(olsr_time_t deadline);
+
+/**
+ * @brief Wake the main loop so it drains newly queued work
+ *
+ * Safe to call from any thread, e.g. after handing the loop an inbound
+ * message or an RRC request, or after queueing an outgoing message.
+ */
+void event_loop_wake(void);
+
+#endif
@@ -18,21 +18,73 @@
 /**
  * @brief Generate a new HELLO message
  * 
- * Creates a HELLO message containing the node's willingness and
- * current neighbor information for broadcast to one-hop neighbors.
+ * Returns the cached HELLO message containing the node's willingness and
+ * current neighbor information for broadcast to one-hop neighbors. The
+ * cache is kept current through the patch/invalidate functions below.
  * 
- * @return Pointer to newly created HELLO message, or NULL on failure
+ * @return Pointer to the static HELLO message (never NULL)
  */
 struct olsr_hello* generate_hello_message(void);
 
+/**
+ * @brief Update the cached HELLO entry of one neighbor
+ * 
+ * Must be called whenever neighbor_table[position] is added, moved or
+ * changes its link status.
+ * 
+ * @param position Index into neighbor_table
+ */
+void patch_hello_neighbor(int position);
+
+/**
+ * @brief Update the cached HELLO entry of one two-hop neighbor
+ * 
+ * Must be called whenever the two-hop table entry at position is added
+ * or moved.
+ * 
+ * @param position Index into the two-hop table
+ */
+void patch_hello_two_hop(int position);
+
+/**
+ * @brief Rebuild the cached HELLO neighbor list on the next HELLO
+ * 
+ * For bulk changes, e.g. after the MPR flags were recalculated.
+ */
+void invalidate_hello_neighbors(void);
+
+/**
+ * @brief Rebuild the cached HELLO two-hop/TDMA list on the next HELLO
+ * 
+ * For bulk changes, e.g. when a slot reservation changed.
+ */
+void invalidate_hello_two_hop(void);
+
 /**
  * @brief Send a HELLO message
  * 
  * Generates and simulates sending a HELLO message. In this implementation,
  * it performs message creation and logging without actual network transmission.
+ * Every HELLO_FULL_INTERVAL-th HELLO is sent in full; the others are
+ * deltas against the previous HELLO.
  */
 void send_hello_message(struct control_queue* queue);
 
+/**
+ * @brief Send the next HELLO in full, e.g. after a HELLO was lost locally
+ */
+void request_full_hello(void);
+
+/**
+ * @brief Record that a HELLO was popped from the control queue for transmission
+ * 
+ * Only a transmitted HELLO may be the base of the next delta; one that was
+ * replaced or dropped in the queue never reached the neighbors.
+ * 
+ * @param msg message_ptr of the popped MSG_HELLO entry
+ */
+void hello_message_transmitted(const struct olsr_hello* msg);
+
 /**
  * @brief Set this node's TDMA slot reservation
  * @param slot Slot number to reserve (>=0), -1 to clear
@@ -46,10 +98,22 @@ void clear_my_slot_reservation(void);
 
 /**
  * @brief Get this node's current reserved slot
- * @return Reserved slot number, or -1 if none
+ * @return Lowest reserved slot number, or -1 if none
  */
 int get_my_reserved_slot(void);
 
+/**
+ * @brief Set this node's TDMA slot reservations
+ * @param slots Slots to reserve (empty to clear)
+ */
+void set_my_slot_reservations(const struct slot_set* slots);
+
+/**
+ * @brief Get this node's reserved slots
+ * @return Set of reserved slots (empty if none)
+ */
+const struct slot_set* get_my_reserved_slots(void);
+
 /**
  * @brief Process a received HELLO message
  * 
@@ -80,12 +144,14 @@ int add_neighbor(uint32_t addr, uint8_t link_code, uint8_t willingness);
  * Updates the link status and willingness of an existing neighbor
  * and refreshes the last-seen timestamp.
  * 
+ * Adds the neighbor if it is not in the table yet.
+ * 
  * @param addr IP address of the neighbor to update
  * @param link_code New link status code
  * @param willingness New willingness value
- * @return 0 on success, -1 if neighbor not found
+ * @return Pointer to the neighbor's entry, or NULL if it could not be added
  */
-void update_neighbor(uint32_t neighbor_addr, int link_type, uint8_t willingness);
+struct neighbor_entry* update_neighbor(uint32_t neighbor_addr, int link_type, uint8_t willingness);
 
 /**
  * @brief Find a neighbor in the neighbor table
@@ -97,6 +163,36 @@ void update_neighbor(uint32_t neighbor_addr, int link_type, uint8_t willingness)
  */
 struct neighbor_entry* find_neighbor(uint32_t addr);
 
+/**
+ * @brief Record where a neighbor lives in the neighbor table
+ * 
+ * Must be called whenever an entry is added to or moved within
+ * neighbor_table so that find_neighbor() stays O(1).
+ * 
+ * @param position Index into neighbor_table of the added or moved entry
+ */
+void index_neighbor_position(int position);
+
+/**
+ * @brief Make room for one more entry at the end of neighbor_table
+ * 
+ * Growing the table moves it, so pointers into it become invalid (and
+ * neighbor_table_generation changes).
+ * 
+ * @return 0 on success, -1 on allocation failure
+ */
+int reserve_neighbor_entry(void);
+
+/**
+ * @brief (Re)arm a neighbor's HELLO timeout timer
+ * 
+ * Must be called whenever last_hello_time is set. The timer removes the
+ * neighbor HELLO_TIMEOUT later unless it is refreshed again.
+ * 
+ * @param entry Neighbor whose last_hello_time was just updated
+ */
+void refresh_neighbor_timer(struct neighbor_entry* entry);
+
 /**
  * @brief Print the current neighbor table
  * 
@@ -136,16 +232,19 @@ int get_mpr_selector_count(void);
 
 // TDMA slot management functions
 void set_my_slot_reservation(int slot_number);
-void update_neighbor_slot_reservation(uint32_t node_id, int slot_number, int hop_distance);
+void update_neighbor_slot_reservation(uint32_t node_id, const struct slot_set* slots, int hop_distance);
 int get_neighbor_slot_reservation(uint32_t node_id);
+int get_neighbor_slot_reservations(uint32_t node_id, struct slot_set* slots);
 int is_slot_available(int slot_number);
 int get_occupied_slots(int* occupied_slots, int max_slots);
+int find_free_slot(int first_slot);
+int count_slot_claims(int slot_number, uint32_t* lowest_claimant);
 void print_tdma_reservations(void);
-void cleanup_expired_reservations(int max_age);
+void cleanup_expired_reservations(olsr_time_t max_age);
 
 /**
- * @brief Check neighbor table for expired HELLO timeouts
- * @return Number of neighbors that failed timeout check
+ * @brief Process neighbors removed by their HELLO timeout timers
+ * @return Number of neighbors that failed timeout check since the last call
  */
 int check_neighbor_timeouts(void);
 
@@ -0,0 +1,49 @@
+/**
+ * @file inbound_queue.h
+ * @brief Hand-off of received messages to the protocol loop
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ *
+ * The RRC/TDMA layer delivers messages on its own thread. Protocol state
+ * (neighbor, two-hop, topology and routing tables, the timer wheel) is
+ * only touched by the protocol loop, so received messages are queued
+ * here and the loop is woken to process them.
+ */
+
+#ifndef INBOUND_QUEUE_H
+#define INBOUND_QUEUE_H
+
+#include <stdint.h>
+
+#define INBOUND_QUEUE_SIZE 64  /**< Received messages waiting for the protocol loop */
+
+/**
+ * @brief A received message and its header fields
+ */
+struct inbound_message {
+    void* message_ptr;       /**< Deserialized body (olsr_hello*, olsr_tc*, data) */
+    uint8_t msg_type;        /**< MSG_HELLO, MSG_TC, MSG_DATA, ... */
+    uint8_t ttl;             /**< Time to live */
+    uint8_t hop_count;       /**< Hops traveled */
+    uint16_t seq_num;        /**< Message sequence number */
+    uint32_t sender_id;      /**< Immediate sender */
+    uint32_t originator_id;  /**< Originator */
+    uint32_t dest_id;        /**< Destination (data messages) */
+};
+
+/**
+ * @brief Queue a received message and wake the protocol loop (any thread)
+ * @param msg Message to copy in; msg->message_ptr must stay valid until processed
+ * @return 0 on success, -1 if the queue is full
+ */
+int inbound_queue_push(const struct inbound_message* msg);
+
+/**
+ * @brief Take up to max queued messages, oldest first (protocol loop only)
+ * @param out Receives the messages
+ * @param max Capacity of out
+ * @return Number of messages taken
+ */
+int inbound_queue_take(struct inbound_message* out, int max);
+
+#endif
@@ -23,7 +23,7 @@
 struct two_hop_neighbor {
     uint32_t neighbor_id;      /**< IP address of the two-hop neighbor */
     uint32_t one_hop_addr;     /**< IP address of one-hop neighbor providing reach */
-    time_t last_seen;          /**< Timestamp of last update */
+    olsr_time_t last_seen;          /**< Timestamp of last update */
     struct two_hop_neighbor *next; /**< Pointer to next entry (for linked list) */
 };
 
@@ -32,6 +32,7 @@ struct two_hop_neighbor {
  * 
  * Adds a new two-hop neighbor to the table or updates an existing one.
  * Two-hop neighbors are nodes reachable through one-hop neighbors.
+ * Entries that are not refreshed expire after NEIGHB_HOLD_TIME.
  * 
  * @param two_hop_addr IP address of the two-hop neighbor
  * @param one_hop_addr IP address of the one-hop neighbor providing reach
@@ -56,6 +57,31 @@ int remove_two_hop_neighbor(uint32_t two_hop_addr, uint32_t one_hop_addr);
  */
 int remove_two_hop_via_neighbor(uint32_t one_hop_addr);
 
+/**
+ * @brief Start applying a full HELLO
+ * 
+ * Two-hop entries added or refreshed from now on count as listed for
+ * remove_unlisted_two_hop().
+ */
+void begin_two_hop_listing(void);
+
+/**
+ * @brief Remove the two-hop neighbors via a one-hop neighbor that were not
+ *        listed since begin_two_hop_listing()
+ * 
+ * @param one_hop_addr IP address of the one-hop neighbor that sent the HELLO
+ * @return Number of two-hop neighbors removed
+ */
+int remove_unlisted_two_hop(uint32_t one_hop_addr);
+
+/**
+ * @brief Refresh every two-hop neighbor reachable via a one-hop neighbor
+ * 
+ * @param one_hop_addr IP address of the one-hop neighbor
+ * @return Number of two-hop neighbors refreshed
+ */
+int refresh_two_hop_via_neighbor(uint32_t one_hop_addr);
+
 /**
  * @brief Calculate MPR set using OLSR MPR selection algorithm
  * 
@@ -70,6 +96,23 @@ int remove_two_hop_via_neighbor(uint32_t one_hop_addr);
  */
 int calculate_mpr_set(void);
 
+/**
+ * @brief Flag the MPR calculation inputs as changed
+ * 
+ * Must be called whenever the symmetric one-hop neighbor set or the
+ * willingness of a symmetric neighbor changes. Two-hop table changes
+ * are flagged by the two-hop functions themselves.
+ */
+void mark_mpr_inputs_changed(void);
+
+/**
+ * @brief Recalculate the MPR set only if its inputs changed
+ * 
+ * @return 1 if the MPR set changed, 0 if it did not (or nothing changed
+ *         since the last calculation), -1 on failure
+ */
+int update_mpr_set(void);
+
 /**
  * @brief Get the current MPR set
  * 
@@ -134,7 +177,11 @@ int get_two_hop_count(void);
 
 /**
  * @brief Get pointer to two-hop neighbor table
- * @return Pointer to two-hop neighbor table array
+ * 
+ * The table is dense but unordered, and the pointer is only valid until
+ * the table next changes.
+ * 
+ * @return Pointer to two-hop neighbor table array (get_two_hop_count() entries)
  */
 struct two_hop_neighbor* get_two_hop_table(void);
 
@@ -0,0 +1,49 @@
+/**
+ * @file node_index.h
+ * @brief Node ID interning shared by all OLSR modules
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ *
+ * Maps 32-bit node IDs to stable dense indices so that per-node state can
+ * be kept in flat arrays and bitsets instead of being searched linearly.
+ * An index, once assigned, keeps referring to the same node for the
+ * lifetime of the process.
+ */
+
+#ifndef NODE_INDEX_H
+#define NODE_INDEX_H
+
+#include <stdint.h>
+
+/**
+ * @brief Get the dense index of a node, assigning one if the node is new
+ * @param node_id Node ID (MAC/TDMA identifier)
+ * @return Dense index (>= 0), or -1 on allocation failure
+ */
+int intern_node(uint32_t node_id);
+
+/**
+ * @brief Get the dense index of a node without assigning one
+ * @param node_id Node ID (MAC/TDMA identifier)
+ * @return Dense index, or -1 if the node has never been interned
+ */
+int lookup_node_index(uint32_t node_id);
+
+/**
+ * @brief Get the node ID behind a dense index
+ * @param index Dense index returned by intern_node()
+ * @return Node ID, or 0 if the index is out of range
+ */
+uint32_t node_id_of(int index);
+
+/**
+ * @brief Get the number of interned nodes
+ *
+ * All valid indices lie in [0, count), so modules can size per-node
+ * arrays from this value.
+ *
+ * @return Number of interned nodes
+ */
+int get_interned_node_count(void);
+
+#endif
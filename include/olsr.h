@@ -14,6 +14,7 @@
 #include<stdint.h>
 #include<stddef.h>
 #include<time.h>
+#include "olsr_clock.h"
 
 /**
  * @defgroup MessageTypes OLSR Message Types
@@ -55,14 +56,16 @@
 
 /**
  * @defgroup Intervals Protocol Timing Intervals
- * @brief Default time intervals for OLSR protocol operations
+ * @brief Default time intervals for OLSR protocol operations (olsr_clock milliseconds)
  * @{
  */
-#define HELLO_INTERVAL 2  /**< HELLO message interval in seconds */
-#define TC_INTERVAL    5  /**< TC message interval in seconds */
-#define TC_VALIDITY_TIME 15  /**< TC message validity time in seconds */
-#define HELLO_TIMEOUT  6  /**< HELLO timeout for link failure detection in seconds */
-#define NEIGHB_HOLD_TIME 10  /**< Neighbor hold time before considering link failed in seconds */
+#define HELLO_INTERVAL OLSR_SECONDS(2)  /**< HELLO message interval */
+#define TC_INTERVAL    OLSR_SECONDS(5)  /**< TC message interval */
+#define TC_VALIDITY_TIME OLSR_SECONDS(15)  /**< TC message validity time */
+#define TC_REFRESH_INTERVAL (TC_VALIDITY_TIME / 3)  /**< Resend an unchanged TC at least this often, so a lost refresh does not expire it */
+#define TC_FULL_INTERVAL OLSR_SECONDS(10)  /**< Send a full TC instead of a delta at least this often */
+#define HELLO_TIMEOUT  OLSR_SECONDS(6)  /**< HELLO timeout for link failure detection */
+#define NEIGHB_HOLD_TIME OLSR_SECONDS(10)  /**< Neighbor hold time before considering link failed */
 /** @} */
 
 /**
@@ -71,8 +74,8 @@
  * @{
  */
 #define MAX_RETRY_ATTEMPTS 3    /**< Maximum number of retry attempts */
-#define RETRY_BASE_INTERVAL 2   /**< Base retry interval in seconds */
-#define MAX_RETRY_INTERVAL 16   /**< Maximum retry interval in seconds */
+#define RETRY_BASE_INTERVAL OLSR_SECONDS(2)   /**< Base retry interval */
+#define MAX_RETRY_INTERVAL OLSR_SECONDS(16)   /**< Maximum retry interval */
 /** @} */
 
 /**
@@ -82,19 +85,25 @@
  */
 #define MAX_TWO_HOP_NEIGHBORS 100    /**< Maximum two-hop neighbors in HELLO */
 #define MAX_TDMA_SLOTS 100           /**< Maximum TDMA slots in system */
-#define SLOT_RESERVATION_TIMEOUT 30  /**< Seconds before reservation expires */
+#define TDMA_SLOT_BYTES 1024         /**< Control payload bytes one TDMA slot carries */
+#define SLOT_RESERVATION_TIMEOUT OLSR_SECONDS(30)  /**< Time before reservation expires */
+#define SLOT_CONFIRM_ROUNDS 2        /**< Collision-free HELLO rounds before a new slot is confirmed */
+#define SLOT_MAX_BACKOFF 4           /**< Maximum HELLO rounds to wait before (re)picking a slot */
+#define SLOT_LOAD_PER_SLOT 4         /**< Messages per HELLO round that one reserved slot carries */
+#define SLOT_MAX_PER_NODE 8          /**< Maximum slots a node reserves, however high its load */
 /** @} */
 
-#define MAX_NEIGHBORS 40  /**< Maximum number of neighbors in table */
+#define MAX_NEIGHBORS 40  /**< Initial capacity of the neighbor table (grows on demand) */
+#define HELLO_FULL_INTERVAL 4  /**< Every Nth HELLO is sent in full, the rest as deltas */
 
 /**
  * @defgroup GlobalRouting Global Routing Constants
  * @brief Constants for global routing and message forwarding
  * @{
  */
-#define MAX_DUPLICATE_ENTRIES 200   /**< Maximum entries in duplicate detection table */
+#define DUPLICATE_WINDOW_SIZE 64    /**< Sequence numbers tracked per originator (bits in window) */
 #define MAX_TOPOLOGY_LINKS 500      /**< Maximum topology links from TC messages */
-#define DUPLICATE_HOLD_TIME 30      /**< Seconds to hold duplicate entries */
+#define DUPLICATE_HOLD_TIME OLSR_SECONDS(30)  /**< Time to hold duplicate entries */
 /** @} */
 
 /**
@@ -106,11 +115,13 @@
 struct neighbor_entry {
     uint32_t neighbor_id;      /**< IP address of the neighbor */
     uint8_t link_status;         /**< Link status (SYM_LINK, ASYM_LINK, etc.) */
-    time_t last_seen;            /**< Timestamp of last received message */
-    time_t last_hello_time;      /**< Timestamp of last HELLO message received */
+    olsr_time_t last_seen;       /**< Timestamp of last received message */
+    olsr_time_t last_hello_time; /**< Timestamp of last HELLO message received */
     uint8_t willingness;         /**< Neighbor's willingness to act as MPR */
     int is_mpr;                  /**< Flag: 1 if neighbor is selected as MPR */
     int is_mpr_selector;         /**< Flag: 1 if neighbor selected this node as MPR */
+    uint16_t hello_seq;          /**< Sequence number of the last HELLO applied from this neighbor */
+    uint8_t hello_synced;        /**< 1 if delta HELLOs from this neighbor can be applied */
     struct neighbor_entry *next; /**< Pointer to next neighbor (for linked list) */
 };
 
@@ -125,7 +136,7 @@ struct olsr_node {
     uint8_t willingness;         /**< This node's willingness to act as MPR */
     uint16_t hello_seq_num;      /**< Sequence number for HELLO messages */
     uint16_t packet_seq_num;     /**< Sequence number for packets */
-    time_t last_hello_time;      /**< Timestamp of last HELLO message sent */
+    olsr_time_t last_hello_time; /**< Timestamp of last HELLO message sent */
     
     struct neighbor_entry *one_hop_neighbors;  /**< List of one-hop neighbors */
     struct two_hop_neighbor *two_hop_neighbors; /**< List of two-hop neighbors */
@@ -136,10 +147,12 @@ struct olsr_node {
     struct control_queue *ctrl_queue; /**< Pointer to control message queue */
 };
 
-/** @brief Global neighbor table array */
-extern struct neighbor_entry neighbor_table[MAX_NEIGHBORS];
+/** @brief Global neighbor table array (dense, unordered, reallocated as it grows) */
+extern struct neighbor_entry* neighbor_table;
 /** @brief Current number of neighbors in table */
 extern int neighbor_count;
+/** @brief Changes whenever neighbor_table entries move or the table is reallocated */
+extern uint32_t neighbor_table_generation;
 
 /** @brief This node's willingness value */
 extern uint8_t node_willingness;
@@ -149,15 +162,16 @@ extern uint32_t node_id;
 extern uint16_t message_seq_num;
 
 /**
- * @brief Duplicate detection table entry
+ * @brief Duplicate detection window of one originator
  * 
  * Used to prevent processing the same message multiple times
- * when messages are flooded through MPR nodes.
+ * when messages are flooded through MPR nodes. Bit i of the window is
+ * set if sequence number top_seq - i (mod 2^16) has been seen.
  */
 struct duplicate_entry {
-    uint32_t originator;     /**< Message originator address */
-    uint16_t seq_number;     /**< Message sequence number */
-    time_t timestamp;        /**< When entry was created */
+    uint16_t top_seq;        /**< Highest sequence number seen */
+    uint64_t window;         /**< Seen-bitmap of the last DUPLICATE_WINDOW_SIZE numbers */
+    olsr_time_t timestamp;   /**< When the window was last updated (0 = unused) */
 };
 
 /**
@@ -169,34 +183,121 @@ struct duplicate_entry {
 // Global routing data structures are managed internally by routing.c
 // No extern declarations needed here
 
-#define MAX_QUEUE_SIZE 100  /**< Maximum size of control message queue */
+#define MAX_QUEUE_SIZE 128  /**< Capacity of the control queue, all classes together */
+#define CACHE_LINE_SIZE 64  /**< Padding unit keeping producer and consumer state apart */
+
+#define CONTROL_QUEUE_FULL (-2)  /**< Push result: ring full, try again after the consumer drains it */
+#define CONTROL_BATCH_MAX 16     /**< Most messages handed to the MAC per TX opportunity */
+
+/**
+ * @defgroup ControlClasses Control queue classes, highest priority first
+ * @{
+ */
+#define CONTROL_CLASS_EMERGENCY 0  /**< Emergency HELLO after a topology change */
+#define CONTROL_CLASS_HELLO     1  /**< Periodic HELLO */
+#define CONTROL_CLASS_TC        2  /**< Locally originated TC */
+#define CONTROL_CLASS_FORWARD   3  /**< TC forwarded for another originator */
+#define CONTROL_CLASS_COUNT     4
+
+/* Ring depth per class; each a power of two, summing to MAX_QUEUE_SIZE */
+#define CONTROL_DEPTH_EMERGENCY 16
+#define CONTROL_DEPTH_HELLO     16
+#define CONTROL_DEPTH_TC        32
+#define CONTROL_DEPTH_FORWARD   64
+/** @} */
+
+/**
+ * @defgroup ControlKeys Control queue keys: at most one pending message each
+ * @{
+ */
+#define CONTROL_KEY_HELLO 0  /**< This node's HELLO (periodic or emergency) */
+#define CONTROL_KEY_TC    1  /**< This node's own TC */
+#define CONTROL_KEY_COUNT 2
+/** @} */
 
 /**
  * @brief Control message structure
  * 
  * Represents a single message in the control queue with metadata and retry logic.
- * Uses a linked list structure where each node stores a pointer to the actual message.
+ * The queue stores these by value; message_ptr points to the actual message.
  */
 struct control_message {
     uint8_t msg_type;        /**< Type of message (MSG_HELLO, MSG_TC, etc.) */
-    time_t timestamp;        /**< Timestamp when message was created */
-    time_t next_retry_time;  /**< Timestamp for next retry attempt */
+    uint8_t msg_class;       /**< Queue class (CONTROL_CLASS_*) */
+    olsr_time_t timestamp;   /**< Timestamp when message was created */
+    olsr_time_t deadline;    /**< Dropped instead of sent if still queued after this */
+    olsr_time_t next_retry_time; /**< Timestamp for next retry attempt */
     int retry_count;         /**< Number of retry attempts made */
     uint32_t destination_id; /**< Destination node ID (for tracking failed links) */
     void* message_ptr;       /**< Pointer to actual message structure (olsr_hello*, olsr_tc*, etc.) */
-    struct control_message* next; /**< Pointer to next message in linked list */
+};
+
+/**
+ * @brief One control queue ring cell
+ * 
+ * sequence == position: free for the producer that claims position.
+ * sequence == position + 1: holds the message pushed at position.
+ */
+struct control_cell {
+    uint32_t sequence;       /**< Cell state, see above (accessed atomically) */
+    uint8_t dropped;         /**< Removed by the consumer's maintenance; pop skips it */
+    struct control_message msg;
+};
+
+/**
+ * @brief Ring of one control queue class
+ * 
+ * The producer and consumer positions sit on separate cache lines.
+ */
+struct control_ring {
+    uint32_t first;          /**< Index of the ring's first cell in control_queue.cells */
+    uint32_t mask;           /**< Ring depth - 1 */
+    uint32_t tail __attribute__((aligned(CACHE_LINE_SIZE)));  /**< Next position to push (also counts every push, wrapping) */
+    uint32_t head __attribute__((aligned(CACHE_LINE_SIZE)));  /**< Next position to pop */
+};
+
+/**
+ * @brief Pending message slot for one key
+ * 
+ * A new message for the key overwrites the pending one. The spinlock is
+ * held only for a struct copy; the class rings stay lock-free.
+ */
+struct control_keyed {
+    uint8_t lock;            /**< Spinlock (accessed atomically) */
+    uint8_t pending;         /**< 1 if msg has not been popped yet */
+    struct control_message msg;
 };
 
 /**
  * @brief Control queue structure
  * 
- * Linked list queue for managing OLSR control messages.
- * Used for queuing HELLO and TC messages before transmission to RRC/TDMA layer.
+ * Fixed-capacity lock-free rings between the OLSR side (producers) and
+ * the RRC/TDMA side (the single consumer), one per class with its own
+ * depth. Pop serves the classes in strict priority order, emergency
+ * HELLO first, and discards messages whose deadline has passed.
+ * Pushing and popping never allocate; a full class ring is reported as
+ * CONTROL_QUEUE_FULL. A queue initialized with init_control_queue()
+ * takes pushes from one thread only; init_control_queue_shared() lets
+ * several threads push (e.g. the receive path forwarding TCs while the
+ * main loop sends HELLOs).
+ * 
+ * This node's HELLO and TC go through push_keyed_message() into a
+ * one-message slot per key instead of a ring: a new HELLO or TC replaces
+ * the one not yet transmitted, so the queue never holds stale copies of
+ * them. A keyed message is popped ahead of the ring of its class.
+ * 
+ * Messages added with add_message_with_retry() are also kept in a
+ * min-heap on their next retry time, owned by the thread that runs
+ * process_retry_queue().
  */
 struct control_queue {
-    struct control_message* head;  /**< Pointer to first message in queue */
-    struct control_message* tail;  /**< Pointer to last message in queue */
-    int count;  /**< Current number of messages in queue */
+    struct control_cell cells[MAX_QUEUE_SIZE];
+    struct control_ring rings[CONTROL_CLASS_COUNT];
+    struct control_keyed keyed[CONTROL_KEY_COUNT];
+    uint32_t keyed_pushed;   /**< Keyed pushes that did not replace a pending message */
+    struct control_message retry_heap[MAX_QUEUE_SIZE];  /**< Pending retries, earliest next_retry_time first */
+    int retry_pending;       /**< Entries in retry_heap */
+    int multi_producer;      /**< 1 if pushes must claim positions atomically */
 };
 
 /**
@@ -205,41 +306,155 @@ struct control_queue {
  */
 void init_control_queue(struct control_queue* queue);
 
+/**
+ * @brief Initialize the control queue for pushes from several threads
+ * @param queue Pointer to the control queue to initialize
+ */
+void init_control_queue_shared(struct control_queue* queue);
+
+/**
+ * @brief Number of messages waiting in the control queue
+ * @param queue Pointer to the control queue
+ * @return Message count, including entries removed by maintenance that pop
+ *         has not skipped yet (a snapshot when other threads are active)
+ */
+int control_queue_count(const struct control_queue* queue);
+
+/**
+ * @brief Number of messages ever pushed to the control queue
+ * @param queue Pointer to the control queue
+ * @return Push counter; wraps, so use differences
+ */
+uint32_t control_queue_pushed(const struct control_queue* queue);
+
 /**
  * @brief Push a message to the control queue
+ * 
+ * HELLOs go to CONTROL_CLASS_HELLO, everything else to CONTROL_CLASS_TC.
+ * 
  * @param queue Pointer to the control queue
  * @param msg_type Type of the message
  * @param message_ptr Pointer to the message structure (olsr_hello*, olsr_tc*, etc.)
- * @return 0 on success, -1 on failure
+ * @return 0 on success, CONTROL_QUEUE_FULL if the ring is full, -1 on other failure
  */
 int push_to_control_queue(struct control_queue* queue, uint8_t msg_type, void* message_ptr);
+
+/**
+ * @brief Push a message to a given class of the control queue
+ * 
+ * The message is dropped at pop time if it is still queued after the
+ * class lifetime: one HELLO interval for HELLOs, one TC interval for TCs.
+ * 
+ * @param queue Pointer to the control queue
+ * @param msg_type Type of the message
+ * @param message_ptr Pointer to the message structure
+ * @param msg_class Queue class (CONTROL_CLASS_*)
+ * @return 0 on success, CONTROL_QUEUE_FULL if the class ring is full, -1 on other failure
+ */
+int push_control_message(struct control_queue* queue, uint8_t msg_type, void* message_ptr, int msg_class);
+
+/**
+ * @brief Queue a message under a key, replacing a pending one with the same key
+ * 
+ * The message keeps the higher of the two classes (an emergency HELLO
+ * replaced by a periodic one still goes out first) and gets a fresh
+ * deadline.
+ * 
+ * @param queue Pointer to the control queue
+ * @param msg_type Type of the message
+ * @param message_ptr Pointer to the message structure
+ * @param msg_class Queue class (CONTROL_CLASS_*)
+ * @param key Message key (CONTROL_KEY_*)
+ * @return 0 on success, -1 on invalid arguments
+ */
+int push_keyed_message(struct control_queue* queue, uint8_t msg_type, void* message_ptr,
+                       int msg_class, int key);
+
+/**
+ * @brief Check whether a keyed message is still waiting to be popped
+ * 
+ * Incremental encodings (delta HELLO/TC) must not be built on top of a
+ * message that may still be replaced before anyone receives it.
+ * 
+ * @param queue Pointer to the control queue
+ * @param key Message key (CONTROL_KEY_*)
+ * @return 1 if pending, 0 otherwise
+ */
+int control_queue_has_pending(struct control_queue* queue, int key);
 /**
- * @brief Pop a message from the control queue
+ * @brief Estimated on-air size of a queued message
+ * 
+ * Counts the message header, the body struct and its arrays, an upper
+ * bound on what the MAC layer serializes.
+ * 
+ * @param msg Queued message
+ * @return Size in bytes
+ */
+size_t control_message_size(const struct control_message* msg);
+
+/**
+ * @brief Pop up to a budget of live messages in priority order (consumer thread only)
+ * 
+ * Fills out_msgs with the messages pop_from_control_queue() would return
+ * one by one, stopping at the first that would exceed either budget; it
+ * stays queued for the next batch. The first message is always taken, so
+ * one larger than max_bytes goes out alone.
+ * 
  * @param queue Pointer to the control queue
- * @return Pointer to control message, or NULL if queue is empty
+ * @param out_msgs Receives copies of the messages, in send order
+ * @param max_msgs Capacity of out_msgs
+ * @param max_bytes Byte budget by control_message_size(), 0 for none
+ * @return Number of messages taken, 0 if the queue is empty
+ */
+int pop_control_batch(struct control_queue* queue, struct control_message* out_msgs,
+                      int max_msgs, size_t max_bytes);
+
+/**
+ * @brief Pop the highest-priority live message (consumer thread only)
+ * @param queue Pointer to the control queue
+ * @param out_msg Receives a copy of the message
+ * @return 0 on success, -1 if the queue is empty
  */
 int pop_from_control_queue(struct control_queue* queue,struct control_message* out_msg);
 
 /**
  * @brief Add a message to the control queue with retry capability
+ * 
+ * The message is queued now and queued again at RETRY_BASE_INTERVAL,
+ * doubling up to MAX_RETRY_INTERVAL, for MAX_RETRY_ATTEMPTS retries.
+ * Call from the thread that runs process_retry_queue().
+ * 
  * @param queue Pointer to the control queue
  * @param msg_type Type of the message
  * @param message_ptr Pointer to the message structure
  * @param destination_id Destination node ID for tracking
- * @return 0 on success, -1 on failure
+ * @return 0 on success, CONTROL_QUEUE_FULL if the ring or the retry heap is full,
+ *         -1 on other failure
  */
 int add_message_with_retry(struct control_queue* queue, uint8_t msg_type, 
                           void* message_ptr, uint32_t destination_id);
 
 /**
- * @brief Process retry queue for message retransmissions
+ * @brief Requeue the messages whose retry time has come
+ * 
+ * Only due entries are touched; use control_queue_next_retry() to
+ * sleep until the next one.
+ * 
  * @param queue Pointer to the control queue
- * @return Number of messages processed
+ * @return Number of messages retried
  */
 int process_retry_queue(struct control_queue* queue);
 
 /**
- * @brief Cleanup expired messages from retry queue
+ * @brief Get the time of the earliest pending retry
+ * @param queue Pointer to the control queue
+ * @param next Receives the retry time
+ * @return 1 if any retry is pending, 0 otherwise
+ */
+int control_queue_next_retry(const struct control_queue* queue, olsr_time_t* next);
+
+/**
+ * @brief Drop queued messages whose class drop deadline has passed (consumer thread only)
  * @param queue Pointer to the control queue
  * @return Number of messages cleaned up
  */
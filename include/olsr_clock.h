@@ -0,0 +1,62 @@
+/**
+ * @file olsr_clock.h
+ * @brief Monotonic millisecond clock shared by all OLSR modules
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ *
+ * All protocol timestamps (neighbor last-seen times, validity times, retry
+ * deadlines, slot reservation ages, timer expiries) are taken from this
+ * clock. The default backend is the system monotonic clock, so wall-clock
+ * adjustments cannot corrupt expiry. A virtual backend lets simulations
+ * drive time explicitly and fast-forward through idle periods.
+ */
+
+#ifndef OLSR_CLOCK_H
+#define OLSR_CLOCK_H
+
+#include <stdint.h>
+
+/** @brief Point in time or duration in milliseconds */
+typedef int64_t olsr_time_t;
+
+#define OLSR_MSEC_PER_SEC 1000  /**< Milliseconds per second */
+
+/** @brief Convert whole seconds to clock ticks */
+#define OLSR_SECONDS(s) ((olsr_time_t)(s) * OLSR_MSEC_PER_SEC)
+
+/**
+ * @brief Get the current time
+ * @return Milliseconds on the active backend (never decreases)
+ */
+olsr_time_t olsr_clock_now(void);
+
+/**
+ * @brief Switch to the system monotonic clock (the default)
+ */
+void olsr_clock_use_monotonic(void);
+
+/**
+ * @brief Switch to a virtual clock that only moves when told to
+ * @param start Initial virtual time in milliseconds (must be > 0)
+ */
+void olsr_clock_use_virtual(olsr_time_t start);
+
+/**
+ * @brief Check which backend is active
+ * @return 1 if the virtual clock is active, 0 otherwise
+ */
+int olsr_clock_is_virtual(void);
+
+/**
+ * @brief Move the virtual clock forward
+ * @param delta Milliseconds to advance (ignored if negative or not virtual)
+ */
+void olsr_clock_advance(olsr_time_t delta);
+
+/**
+ * @brief Move the virtual clock forward to an absolute time
+ * @param when Target time; earlier times are ignored so time never goes back
+ */
+void olsr_clock_advance_to(olsr_time_t when);
+
+#endif
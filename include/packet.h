@@ -14,6 +14,7 @@
 #include<stdint.h>
 #include<time.h>
 #include "olsr.h"
+#include "slot_set.h"
 
 /**
  * @brief OLSR packet structure
@@ -35,7 +36,7 @@ struct olsr_packet {
  */
 struct olsr_message {
 	uint8_t msg_type;      /**< Message type (MSG_HELLO, MSG_TC, etc.) */
-	uint8_t vtime;         /**< Validity time for the message */
+	uint8_t vtime;         /**< Validity time for the message in seconds */
 	uint16_t msg_size;     /**< Size of the message including header */
 	uint32_t originator;   /**< IP address of the message originator */
   uint8_t ttl;           /**< Time To Live - hop limit for message */ 
@@ -44,18 +45,29 @@ struct olsr_message {
 	void *body;            /**< Pointer to message body (olsr_hello/olsr_tc) */
 };
 
+#define TC_FULL  0  /**< TC carries the complete MPR selector set */
+#define TC_DELTA 1  /**< TC carries only the selectors added and removed since base_ansn */
+
 /**
  * @brief Topology Control (TC) message structure
  * 
  * TC messages are used to disseminate topology information throughout
  * the network. They contain MPR selector information.
+ * 
+ * The ANSN only changes when the selector set does. A TC sent for a new
+ * ANSN may be a delta against the previous one: mpr_selectors then lists
+ * the added selectors and removed_selectors the withdrawn ones.
  */
 struct olsr_tc{
 	uint16_t ansn;         /**< Advertised Neighbor Sequence Number */
+	uint8_t tc_type;       /**< TC_FULL or TC_DELTA */
+	uint16_t base_ansn;    /**< TC_DELTA: ANSN the changes apply to */
 	struct tc_neighbor {
 		uint32_t neighbor_addr; /**< IP address of MPR selector */
-	} *mpr_selectors;      /**< Array of MPR selectors */
+	} *mpr_selectors;      /**< Array of MPR selectors (TC_DELTA: added selectors) */
 	int selector_count;    /**< Number of MPR selectors in the array */
+	struct tc_neighbor* removed_selectors; /**< TC_DELTA: withdrawn selectors */
+	int removed_count;     /**< Number of withdrawn selectors */
 };
 
 /**
@@ -67,29 +79,43 @@ struct olsr_tc{
 struct two_hop_hello_neighbor {
     uint32_t two_hop_id;        /**< Two-hop neighbor node ID */
     uint32_t via_neighbor_id;   /**< One-hop neighbor providing the path */
-    int reserved_slot;          /**< TDMA slot reserved by two-hop neighbor (-1 = no reservation) */
+    struct slot_set reserved_slots; /**< TDMA slots reserved by the two-hop neighbor (empty = none) */
 };
 
+#define HELLO_FULL  0  /**< HELLO carries the complete neighbor and two-hop/TDMA lists */
+#define HELLO_DELTA 1  /**< HELLO carries only entries changed since HELLO base_seq */
+#define HELLO_LINK_REMOVED 0xFF  /**< Delta link code: neighbor is no longer advertised */
+
 /**
  * @brief HELLO message structure
  * 
  * HELLO messages are used for neighbor discovery and link sensing.
  * They are broadcast periodically to one-hop neighbors.
+ * 
+ * Every HELLO_FULL_INTERVAL-th HELLO is a full HELLO; the ones in between
+ * are deltas listing only neighbors that were added, removed (link code
+ * HELLO_LINK_REMOVED) or changed link code or slots, and two-hop nodes whose slots
+ * changed, since the previous HELLO. A receiver that missed a HELLO sees
+ * base_seq skip and waits for the next full HELLO.
  */
 struct olsr_hello {
-	uint16_t hello_interval; /**< Interval between HELLO messages in seconds */
+	uint16_t hello_interval; /**< Interval between HELLO messages in milliseconds */
 	uint8_t willingness;      /**< Node's willingness to act as MPR (0-7) */
 	uint8_t reserved;        /**< Slot number reserved -1 for not reserved, slot numbers for reserved */
+	uint8_t hello_type;      /**< HELLO_FULL or HELLO_DELTA */
+	uint16_t hello_seq;      /**< Sequence number of this HELLO */
+	uint16_t base_seq;       /**< HELLO_DELTA: sequence number of the HELLO the changes apply to */
 
 	/**
 	 * @brief TDMA slot reservation announcement
-	 * @details -1 means no reservation, >=0 means slot number reserved
-	 * Example: reserved_slot = 10 means "I am using slot 10"
+	 * @details Bitmap of the slots this node transmits in; empty means no reservation.
+	 * Example: bits 10 and 42 set means "I am using slots 10 and 42"
 	 */
-	int reserved_slot;
+	struct slot_set reserved_slots;
 	struct hello_neighbor {
 		uint32_t neighbor_id; /**< Node ID of discovered neighbor */
 		uint8_t link_code;      /**< Link type and neighbor type code */
+		struct slot_set reserved_slots; /**< TDMA slots reserved by the neighbor (empty = none) */
 	} *neighbors;            /**< Array of neighbor information */
 	int neighbor_count;      /**< Number of neighbors in the array */
 	
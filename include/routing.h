@@ -10,13 +10,15 @@
 
 #include <stdint.h>
 #include <limits.h>
-#include <time.h>
+#include "olsr_clock.h"
 
-#define MAX_ROUTING_ENTRIES 100  /**< Maximum entries in routing table */
+#define MAX_ROUTING_ENTRIES 100  /**< Initial capacity of the routing table */
 #define INFINITE_COST INT_MAX    /**< Infinite cost for unreachable nodes */
 #define MAX_NODES 50            /**< Maximum nodes in topology */
 #define MAX_TOPOLOGY_LINKS 500  /**< Maximum topology links from TC messages */
 
+struct neighbor_entry;
+
 /**
  * @brief Routing table entry structure
  * 
@@ -28,7 +30,9 @@ struct routing_table_entry {
     uint32_t next_hop_id; /**< Next hop node ID (MAC/TDMA identifier) */
     uint32_t metric;     /**< Cost/distance to destination */
     int hops;           /**< Number of hops to destination */
-    time_t timestamp;   /**< When this entry was last updated */
+    olsr_time_t timestamp;   /**< When this entry was last updated */
+    struct neighbor_entry* next_hop_entry; /**< Cached neighbor entry of next_hop_id (may be stale) */
+    uint32_t neighbor_generation; /**< neighbor_table_generation when next_hop_entry was cached */
 };
 
 /**
@@ -41,7 +45,7 @@ struct topology_link {
     uint32_t from_id;    /**< Source node ID (MAC/TDMA identifier) */
     uint32_t to_id;      /**< Destination node ID (MAC/TDMA identifier) */
     int cost;           /**< Link cost (usually 1 for OLSR) */
-    time_t validity;    /**< When this link expires */
+    olsr_time_t validity;    /**< When this link expires */
 };
 
 /**
@@ -94,13 +98,49 @@ void clear_routing_table(void);
 void update_routing_table(void);
 
 /**
- * @brief Add or update a topology link from TC message
+ * @brief Bring the routing table up to date after topology changes
+ * 
+ * Falls back to a full recalculation only when some link change or
+ * expiry could not be repaired in the shortest path tree in place.
+ */
+void refresh_routing_table(void);
+
+/**
+ * @brief Apply a single link addition to the shortest path tree
+ * 
+ * Repairs only the subtree whose distances improve and publishes only
+ * the routing entries that actually change.
+ * 
+ * @param from_id Source node ID (MAC/TDMA identifier)
+ * @param to_id Destination node ID (MAC/TDMA identifier)
+ * @return Number of routing entries changed, or -1 if a full recalculation is required
+ */
+int routing_link_added(uint32_t from_id, uint32_t to_id);
+
+/**
+ * @brief Apply a single link removal to the shortest path tree
+ * 
+ * Detaches and re-settles only the subtree that hung below the removed
+ * link and publishes only the routing entries that actually change.
+ * 
+ * @param from_id Source node ID (MAC/TDMA identifier)
+ * @param to_id Destination node ID (MAC/TDMA identifier)
+ * @return Number of routing entries changed, or -1 if a full recalculation is required
+ */
+int routing_link_removed(uint32_t from_id, uint32_t to_id);
+
+/**
+ * @brief Add or update a topology link from TC message (legacy wrapper)
+ * 
+ * Merges the link into the originator's set in the global topology
+ * database; new code should use update_topology_set().
+ * 
  * @param from_id Source node ID (MAC/TDMA identifier)
  * @param to_id Destination node ID (MAC/TDMA identifier)
  * @param validity Validity time
- * @return 0 on success, -1 if topology table is full
+ * @return 0 on success, -1 on allocation failure
  */
-int update_tc_topology(uint32_t from_id, uint32_t to_id, time_t validity);
+int update_tc_topology(uint32_t from_id, uint32_t to_id, olsr_time_t validity);
 
 /**
  * @brief Remove expired TC topology links
@@ -138,4 +178,16 @@ int has_route_to(uint32_t dest_id);
  */
 struct routing_table_entry* get_routing_entry(uint32_t dest_id);
 
+/**
+ * @brief Thread-safe route lookup against the last published routing table
+ * 
+ * Never blocks and never sees a partially rebuilt table. Unlike
+ * get_next_hop(), it does not validate the next hop or trigger rerouting.
+ * 
+ * @param dest_id Destination node ID (MAC/TDMA identifier)
+ * @param route Receives a copy of the routing entry
+ * @return 1 if destination is self, 0 if route found, -1 if no route
+ */
+int lookup_route(uint32_t dest_id, struct routing_table_entry* route);
+
 #endif // ROUTING_H
\ No newline at end of file
@@ -0,0 +1,70 @@
+/**
+ * @file slot_alloc.h
+ * @brief Distributed TDMA slot allocation
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ *
+ * Picks this node's TDMA slots from the one-hop and two-hop reservations
+ * learned from HELLO messages, so no slot is shared within two hops
+ * (which would collide at a common neighbor, the hidden-terminal case).
+ * The engine runs once per HELLO round:
+ *
+ * - The number of slots follows the send load: messages queued on the
+ *   control queue (this node's HELLO/TC and the TCs it relays) plus the
+ *   data messages it forwards (slot_alloc_note_forwarded()), averaged over a few
+ *   rounds, one slot per SLOT_LOAD_PER_SLOT messages per round (at least
+ *   one, at most SLOT_MAX_PER_NODE).
+ * - With fewer slots than that it backs off for a random
+ *   1..SLOT_MAX_BACKOFF rounds, picks the missing ones at random among the
+ *   free slots and announces them in the next HELLO (tentative). Slots no
+ *   longer needed are released.
+ * - Collisions are checked slot by slot: if another node within two hops
+ *   claims one of our slots, the node with the lower ID keeps it; the
+ *   other releases only that slot and backs off before picking again.
+ * - Slots held for SLOT_CONFIRM_ROUNDS rounds without collision are
+ *   confirmed. Confirmed slots still yield to a lower-ID claimant.
+ *
+ * Slots set through set_my_slot_reservations() are adopted as confirmed.
+ */
+
+#ifndef SLOT_ALLOC_H
+#define SLOT_ALLOC_H
+
+#include "olsr.h"
+
+#define SLOT_ALLOC_DISABLED  0  /**< Engine off; slots are managed externally */
+#define SLOT_ALLOC_BACKOFF   1  /**< Short of slots; waiting before picking more */
+#define SLOT_ALLOC_TENTATIVE 2  /**< New slots announced, watching for collisions */
+#define SLOT_ALLOC_OWNED     3  /**< Slots confirmed */
+
+/**
+ * @brief Turn automatic slot allocation on or off
+ *
+ * Enabling starts with a random backoff so that nodes booted together
+ * listen to at least one HELLO round and do not all pick at once.
+ *
+ * @param enabled 1 to enable, 0 to disable (the current slots are kept)
+ */
+void slot_alloc_enable(int enabled);
+
+/**
+ * @brief Run one allocation round; call once per HELLO interval before sending the HELLO
+ * @param queue Control queue whose traffic counts toward the load (may be NULL)
+ * @return Number of slots this node holds after the round
+ */
+int slot_alloc_run(const struct control_queue* queue);
+
+/**
+ * @brief Count one forwarded data message toward the load
+ *
+ * Safe to call from the receive path on another thread.
+ */
+void slot_alloc_note_forwarded(void);
+
+/**
+ * @brief Get the allocation state
+ * @return One of the SLOT_ALLOC_* states
+ */
+int slot_alloc_get_state(void);
+
+#endif
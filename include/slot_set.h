@@ -0,0 +1,126 @@
+/**
+ * @file slot_set.h
+ * @brief Bitmap of TDMA slots
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ *
+ * A node may reserve several slots per frame, so reservations are carried
+ * as a fixed-size bitmap (one bit per slot) in HELLO messages and in the
+ * reservation table. All operations are a few word operations.
+ */
+
+#ifndef SLOT_SET_H
+#define SLOT_SET_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "olsr.h"
+
+/** @brief 64-bit words in a TDMA slot bitmap */
+#define SLOT_BITMAP_WORDS ((MAX_TDMA_SLOTS + 63) / 64)
+
+/**
+ * @brief Set of TDMA slots, bit n set = slot n reserved
+ */
+struct slot_set {
+    uint64_t bits[SLOT_BITMAP_WORDS];
+};
+
+/** @brief Empty the set */
+static inline void slot_set_clear(struct slot_set* set) {
+    for (int w = 0; w < SLOT_BITMAP_WORDS; w++) {
+        set->bits[w] = 0;
+    }
+}
+
+/** @brief Add a slot (ignored unless 0 <= slot < MAX_TDMA_SLOTS) */
+static inline void slot_set_add(struct slot_set* set, int slot) {
+    if (slot >= 0 && slot < MAX_TDMA_SLOTS) {
+        set->bits[slot / 64] |= 1ULL << (slot % 64);
+    }
+}
+
+/** @brief Remove a slot */
+static inline void slot_set_remove(struct slot_set* set, int slot) {
+    if (slot >= 0 && slot < MAX_TDMA_SLOTS) {
+        set->bits[slot / 64] &= ~(1ULL << (slot % 64));
+    }
+}
+
+/** @brief Check whether a slot is in the set */
+static inline int slot_set_has(const struct slot_set* set, int slot) {
+    return slot >= 0 && slot < MAX_TDMA_SLOTS && ((set->bits[slot / 64] >> (slot % 64)) & 1);
+}
+
+/** @brief Number of slots in the set */
+static inline int slot_set_count(const struct slot_set* set) {
+    int count = 0;
+    for (int w = 0; w < SLOT_BITMAP_WORDS; w++) {
+        count += __builtin_popcountll(set->bits[w]);
+    }
+    return count;
+}
+
+/** @brief Lowest slot in the set, or -1 if empty */
+static inline int slot_set_first(const struct slot_set* set) {
+    for (int w = 0; w < SLOT_BITMAP_WORDS; w++) {
+        if (set->bits[w]) {
+            return w * 64 + __builtin_ctzll(set->bits[w]);
+        }
+    }
+    return -1;
+}
+
+/** @brief Lowest slot in the set above a given slot, or -1 if none */
+static inline int slot_set_next(const struct slot_set* set, int slot) {
+    int next = slot + 1;
+    if (next < 0) {
+        next = 0;
+    }
+    for (int w = next / 64; w < SLOT_BITMAP_WORDS; w++) {
+        uint64_t bits = set->bits[w];
+        if (w == next / 64) {
+            bits &= ~0ULL << (next % 64);
+        }
+        if (bits) {
+            return w * 64 + __builtin_ctzll(bits);
+        }
+    }
+    return -1;
+}
+
+/** @brief Check whether two sets hold the same slots */
+static inline int slot_set_equal(const struct slot_set* a, const struct slot_set* b) {
+    for (int w = 0; w < SLOT_BITMAP_WORDS; w++) {
+        if (a->bits[w] != b->bits[w]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/** @brief Buffer size for slot_set_format() */
+#define SLOT_SET_STRING_LEN 64
+
+/**
+ * @brief Format a set for logging as "3,7,12" ("none" if empty)
+ * @param buffer At least SLOT_SET_STRING_LEN bytes; long lists end in "..."
+ * @return buffer
+ */
+static inline char* slot_set_format(const struct slot_set* set, char* buffer) {
+    int len = 0;
+    buffer[0] = '\0';
+    for (int slot = slot_set_first(set); slot >= 0; slot = slot_set_next(set, slot)) {
+        if (len > SLOT_SET_STRING_LEN - 8) {
+            snprintf(buffer + len, SLOT_SET_STRING_LEN - len, "...");
+            return buffer;
+        }
+        len += snprintf(buffer + len, SLOT_SET_STRING_LEN - len, len ? ",%d" : "%d", slot);
+    }
+    if (len == 0) {
+        snprintf(buffer, SLOT_SET_STRING_LEN, "none");
+    }
+    return buffer;
+}
+
+#endif
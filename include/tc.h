@@ -34,6 +34,31 @@ int remove_mpr_selector(uint32_t selector_addr);
  */
 void send_tc_message(struct control_queue* queue);
 
+/**
+ * @brief Record that a TC was popped from the control queue for transmission
+ * 
+ * The last transmitted TC is the base of the next delta and restarts the
+ * refresh interval; a TC replaced or dropped in the queue is neither.
+ * Forwarded TCs are ignored.
+ * 
+ * @param msg message_ptr of the popped MSG_TC entry
+ */
+void tc_message_transmitted(const struct olsr_tc* msg);
+
+/**
+ * @brief Ask the protocol loop to originate a TC now
+ * 
+ * Safe to call from any thread: it only sets a flag and wakes the loop,
+ * which sends the TC on its own queue at its next iteration.
+ */
+void request_tc_message(void);
+
+/**
+ * @brief Take a pending request_tc_message() (protocol loop only)
+ * @return 1 if a TC was requested since the last call, 0 otherwise
+ */
+int take_tc_request(void);
+
 /**
  * @brief Process a received TC message
  * @param msg Pointer to the OLSR message containing the TC
@@ -61,6 +86,46 @@ uint16_t get_current_ansn(void);
  * @param validity_time When this link expires
  * @return 0 on success, -1 on failure
  */
-int add_topology_link(uint32_t from_node, uint32_t to_node, uint16_t ansn, time_t validity_time);
+int add_topology_link(uint32_t from_node, uint32_t to_node, uint16_t ansn, olsr_time_t validity_time);
+
+/**
+ * @brief Replace an originator's advertised neighbor set in the global database
+ * 
+ * The set is replaced only if the ANSN is not older than the stored one
+ * (compared with 16-bit wraparound). Only links that actually appear or
+ * disappear are applied to the routing tree, in O(degree).
+ * 
+ * @param originator Originator of the TC message
+ * @param ansn ANSN of the TC message
+ * @param advertised Advertised neighbor IDs
+ * @param count Number of advertised neighbors
+ * @param validity_time When the set expires
+ * @return Number of links added or removed, or -1 on failure
+ */
+int update_topology_set(uint32_t originator, uint16_t ansn, const uint32_t* advertised,
+                        int count, olsr_time_t validity_time);
+
+/**
+ * @brief Apply a delta TC to an originator's advertised neighbor set
+ * 
+ * The delta moves the set from base_ansn to ansn. It is only applied if
+ * the stored set is still valid and at exactly base_ansn; otherwise the
+ * caller has to wait for the originator's next full TC.
+ * 
+ * @param originator Originator of the TC message
+ * @param base_ansn ANSN the changes apply to
+ * @param ansn ANSN after the changes
+ * @param added Neighbor IDs added to the set
+ * @param added_count Number of added neighbors
+ * @param removed Neighbor IDs withdrawn from the set
+ * @param removed_count Number of withdrawn neighbors
+ * @param validity_time When the set expires
+ * @return Number of links added or removed, 0 if the set already has this
+ *         ANSN or a newer one, or -1 if the delta cannot be applied
+ */
+int apply_topology_delta(uint32_t originator, uint16_t base_ansn, uint16_t ansn,
+                         const uint32_t* added, int added_count,
+                         const uint32_t* removed, int removed_count,
+                         olsr_time_t validity_time);
 
 #endif
\ No newline at end of file
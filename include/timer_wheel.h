@@ -0,0 +1,71 @@
+/**
+ * @file timer_wheel.h
+ * @brief Hierarchical timing wheel shared by all soft-state expiry
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ *
+ * Soft-state entries (neighbors, slot reservations, topology sets,
+ * duplicate windows) register a timer when they are inserted or
+ * refreshed instead of being found by periodic full-table sweeps.
+ * Timers are identified by their callback and a 32-bit key (usually a
+ * node ID), so re-arming an existing timer simply moves it. Arming,
+ * re-arming, cancelling and firing are all O(1).
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include "olsr_clock.h"
+
+/**
+ * @brief Timer expiry callback
+ *
+ * Called once when the timer expires; the timer is disarmed before the
+ * call, so the callback may re-arm or cancel any timer, including its own.
+ *
+ * @param key Key the timer was scheduled with
+ */
+typedef void (*timer_callback)(uint32_t key);
+
+/**
+ * @brief Arm a timer, or move it if (callback, key) is already armed
+ * @param callback Function to call on expiry
+ * @param key Caller-defined key passed back to the callback
+ * @param expires Absolute expiry time (olsr_clock_now() time base)
+ * @return 0 on success, -1 on allocation failure
+ */
+int timer_wheel_schedule(timer_callback callback, uint32_t key, olsr_time_t expires);
+
+/**
+ * @brief Disarm a timer if it is armed
+ * @param callback Callback the timer was scheduled with
+ * @param key Key the timer was scheduled with
+ */
+void timer_wheel_cancel(timer_callback callback, uint32_t key);
+
+/**
+ * @brief Fire every timer that has expired by now
+ * @return Number of timers fired
+ */
+int timer_wheel_run(void);
+
+/**
+ * @brief Get a time by which the wheel next needs to run
+ *
+ * Exact for timers due within the next wheel rotation; for timers further
+ * out it may be earlier than the true expiry (the wheel then only
+ * reshuffles timers without firing any).
+ *
+ * @param next Receives the wake-up time
+ * @return 1 if any timer is armed, 0 otherwise
+ */
+int timer_wheel_next_expiry(olsr_time_t* next);
+
+/**
+ * @brief Get the number of armed timers
+ * @return Number of armed timers
+ */
+int timer_wheel_count(void);
+
+#endif
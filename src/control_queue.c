@@ -3,96 +3,486 @@
 #include <stdlib.h>
 #include "../include/packet.h"
 #include "../include/olsr.h"
+#include "../include/event_loop.h"
 #include <stdio.h>
 #include <stdint.h>
 
+/*
+ * One bounded ring per class, each with a sequence number per cell
+ * (Vyukov's bounded queue). A producer claims position p when cell p's
+ * sequence equals p, copies the message in and publishes it by setting
+ * the sequence to p + 1. The consumer pops position p once its sequence
+ * is p + 1 and hands the cell back for position p + depth. With one
+ * producer the claim is a plain store; with several it is a
+ * compare-and-swap on the tail.
+ *
+ * Expiry runs on the consumer side over published cells only. Removed
+ * entries are marked dropped and skipped by pop, so cells are never moved
+ * while producers may be writing.
+ *
+ * Keyed messages (this node's HELLO and TC) bypass the rings: each key
+ * has a single slot that a newer message overwrites, guarded by a
+ * spinlock held for one struct copy.
+ *
+ * The consumer drains in batches: pop_control_batch() reads the clock
+ * once, takes each keyed lock at most once and stores each ring's head
+ * once, however many messages it hands out.
+ *
+ * Retries do not scan the rings: each retryable message has an entry in
+ * retry_heap, a binary min-heap on next_retry_time, and is pushed to its
+ * ring again when its entry comes due.
+ */
+
+#if CONTROL_DEPTH_EMERGENCY + CONTROL_DEPTH_HELLO + CONTROL_DEPTH_TC + CONTROL_DEPTH_FORWARD != MAX_QUEUE_SIZE
+#error "Control class depths must add up to MAX_QUEUE_SIZE"
+#endif
+
+/** @brief Ring depth of each class (powers of two) */
+static const uint32_t class_depth[CONTROL_CLASS_COUNT] = {
+    CONTROL_DEPTH_EMERGENCY, CONTROL_DEPTH_HELLO, CONTROL_DEPTH_TC, CONTROL_DEPTH_FORWARD
+};
+
+/** @brief How long a message of each class may wait before it is stale */
+static const olsr_time_t class_lifetime[CONTROL_CLASS_COUNT] = {
+    HELLO_INTERVAL,  // Emergency HELLO: superseded by the next periodic one
+    HELLO_INTERVAL,
+    TC_INTERVAL,
+    TC_INTERVAL
+};
+
+static const char* const class_names[CONTROL_CLASS_COUNT] = {
+    "emergency HELLO", "HELLO", "TC", "forwarded TC"
+};
+
+static void init_queue(struct control_queue* queue, int multi_producer) {
+    uint32_t first = 0;
+    for (int c = 0; c < CONTROL_CLASS_COUNT; c++) {
+        struct control_ring* ring = &queue->rings[c];
+        ring->first = first;
+        ring->mask = class_depth[c] - 1;
+        ring->tail = 0;
+        ring->head = 0;
+        for (uint32_t i = 0; i < class_depth[c]; i++) {
+            queue->cells[first + i].sequence = i;
+            queue->cells[first + i].dropped = 0;
+        }
+        first += class_depth[c];
+    }
+    for (int k = 0; k < CONTROL_KEY_COUNT; k++) {
+        queue->keyed[k].lock = 0;
+        queue->keyed[k].pending = 0;
+    }
+    queue->keyed_pushed = 0;
+    queue->retry_pending = 0;
+    queue->multi_producer = multi_producer;
+}
+
+static void keyed_lock(struct control_keyed* slot) {
+    while (__atomic_test_and_set(&slot->lock, __ATOMIC_ACQUIRE)) {
+        // Held for a struct copy (and a size check) at most; spin
+    }
+}
+
+static void keyed_unlock(struct control_keyed* slot) {
+    __atomic_clear(&slot->lock, __ATOMIC_RELEASE);
+}
+
 void init_control_queue(struct control_queue* queue) {
-    queue->head = NULL;
-    queue->tail = NULL;
-    queue->count = 0;
+    init_queue(queue, 0);
+}
+
+void init_control_queue_shared(struct control_queue* queue) {
+    init_queue(queue, 1);
+}
+
+int control_queue_count(const struct control_queue* queue) {
+    int total = 0;
+    for (int c = 0; c < CONTROL_CLASS_COUNT; c++) {
+        const struct control_ring* ring = &queue->rings[c];
+        uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        int count = (int)(tail - head);
+        if (count < 0) {
+            count = 0;  // Positions read while the other side moved
+        }
+        total += count > (int)class_depth[c] ? (int)class_depth[c] : count;
+    }
+    for (int k = 0; k < CONTROL_KEY_COUNT; k++) {
+        total += __atomic_load_n(&queue->keyed[k].pending, __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+uint32_t control_queue_pushed(const struct control_queue* queue) {
+    uint32_t pushed = __atomic_load_n(&queue->keyed_pushed, __ATOMIC_RELAXED);
+    for (int c = 0; c < CONTROL_CLASS_COUNT; c++) {
+        pushed += __atomic_load_n(&queue->rings[c].tail, __ATOMIC_RELAXED);
+    }
+    return pushed;
+}
+
+/**
+ * @brief Cell holding a ring position
+ */
+static struct control_cell* ring_cell(struct control_queue* queue, struct control_ring* ring, uint32_t pos) {
+    return &queue->cells[ring->first + (pos & ring->mask)];
+}
+
+/**
+ * @brief Claim a cell in the message's class ring, copy the message in and publish it
+ * @return 0 on success, CONTROL_QUEUE_FULL if every cell of the class is in use
+ */
+static int enqueue(struct control_queue* queue, const struct control_message* msg) {
+    struct control_ring* ring = &queue->rings[msg->msg_class];
+    uint32_t pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    struct control_cell* cell;
+    for (;;) {
+        cell = ring_cell(queue, ring, pos);
+        uint32_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(sequence - pos);
+        if (diff == 0) {
+            if (!queue->multi_producer) {
+                __atomic_store_n(&ring->tail, pos + 1, __ATOMIC_RELAXED);
+                break;
+            }
+            if (__atomic_compare_exchange_n(&ring->tail, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+            // Lost the race; pos now holds the current tail
+        } else if (diff < 0) {
+            return CONTROL_QUEUE_FULL;  // Cell still holds a message from one lap ago
+        } else {
+            pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+        }
+    }
+    
+    cell->msg = *msg;
+    cell->dropped = 0;
+    __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+    event_loop_wake();
+    return 0;
+}
+
+/**
+ * @brief Published cell at a ring position, or NULL if none has been pushed there yet
+ */
+static struct control_cell* published_cell(struct control_queue* queue, struct control_ring* ring, uint32_t pos) {
+    struct control_cell* cell = ring_cell(queue, ring, pos);
+    if (__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) != pos + 1) {
+        return NULL;
+    }
+    return cell;
+}
+
+/**
+ * @brief Insert a retry entry into the heap (room already checked)
+ */
+static void retry_heap_push(struct control_queue* queue, const struct control_message* msg) {
+    struct control_message* heap = queue->retry_heap;
+    int i = queue->retry_pending++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (heap[parent].next_retry_time <= msg->next_retry_time) {
+            break;
+        }
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = *msg;
+}
+
+/**
+ * @brief Remove the earliest retry entry from the heap (must not be empty)
+ */
+static void retry_heap_pop(struct control_queue* queue, struct control_message* out_msg) {
+    struct control_message* heap = queue->retry_heap;
+    *out_msg = heap[0];
+    struct control_message last = heap[--queue->retry_pending];
+    int count = queue->retry_pending;
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && heap[child + 1].next_retry_time < heap[child].next_retry_time) {
+            child++;
+        }
+        if (last.next_retry_time <= heap[child].next_retry_time) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (count > 0) {
+        heap[i] = last;
+    }
+}
+
+int control_queue_next_retry(const struct control_queue* queue, olsr_time_t* next) {
+    if (queue->retry_pending == 0) {
+        return 0;
+    }
+    *next = queue->retry_heap[0].next_retry_time;
+    return 1;
+}
+
+/**
+ * @brief Default class of a message type
+ */
+static int default_class(uint8_t msg_type) {
+    return msg_type == MSG_HELLO ? CONTROL_CLASS_HELLO : CONTROL_CLASS_TC;
 }
 
 int push_to_control_queue(struct control_queue* queue, uint8_t msg_type, void* message_ptr) {
-    // Check if message pointer is valid
+    return push_control_message(queue, msg_type, message_ptr, default_class(msg_type));
+}
+
+int push_control_message(struct control_queue* queue, uint8_t msg_type, void* message_ptr, int msg_class) {
+    // Check if message pointer and class are valid
     if (!message_ptr) {
         printf("Error: NULL message pointer\n");
         return -1;
     }
-    
-    // Allocate new node for linked list
-    struct control_message* new_node = (struct control_message*)malloc(sizeof(struct control_message));
-    if (!new_node) {
-        printf("Error: Failed to allocate memory for control message\n");
+    if (msg_class < 0 || msg_class >= CONTROL_CLASS_COUNT) {
+        printf("Error: Invalid control queue class %d\n", msg_class);
         return -1;
     }
     
     // Fill in the message (basic version without retry)
-    new_node->msg_type = msg_type;
-    new_node->timestamp = time(NULL);
-    new_node->next_retry_time = 0;  // No retry for basic push
-    new_node->retry_count = 0;
-    new_node->destination_id = 0;   // No specific destination
-    new_node->message_ptr = message_ptr;  // Store pointer to message structure
-    new_node->next = NULL;
+    struct control_message msg;
+    msg.msg_type = msg_type;
+    msg.msg_class = (uint8_t)msg_class;
+    msg.timestamp = olsr_clock_now();
+    msg.deadline = msg.timestamp + class_lifetime[msg_class];
+    msg.next_retry_time = 0;  // No retry for basic push
+    msg.retry_count = 0;
+    msg.destination_id = 0;   // No specific destination
+    msg.message_ptr = message_ptr;  // Store pointer to message structure
     
-    // Add to linked list (append at tail)
-    if (queue->tail == NULL) {
-        // Queue is empty
-        queue->head = new_node;
-        queue->tail = new_node;
-    } else {
-        // Queue has elements, append at tail
-        queue->tail->next = new_node;
-        queue->tail = new_node;
+    int result = enqueue(queue, &msg);
+    if (result == CONTROL_QUEUE_FULL) {
+        printf("Error: Control queue full (%u %s messages), message type %d rejected\n",
+               class_depth[msg_class], class_names[msg_class], msg_type);
     }
-    
-    queue->count++;
-    
-    return 0;  // Success
+    return result;
 }
 
-int pop_from_control_queue(struct control_queue* queue,
-                           struct control_message* out_msg) {
-    // Check if queue is empty
-    if (queue->count == 0 || queue->head == NULL) {
-        return -1;  // Error: queue empty
+int push_keyed_message(struct control_queue* queue, uint8_t msg_type, void* message_ptr,
+                       int msg_class, int key) {
+    if (!message_ptr) {
+        printf("Error: NULL message pointer\n");
+        return -1;
+    }
+    if (msg_class < 0 || msg_class >= CONTROL_CLASS_COUNT || key < 0 || key >= CONTROL_KEY_COUNT) {
+        printf("Error: Invalid control queue class %d or key %d\n", msg_class, key);
+        return -1;
     }
     
-    // Get the first message node
-    struct control_message* node = queue->head;
-    
-    // COPY the message content to caller's buffer
-    memcpy(out_msg, node, sizeof(struct control_message));
-    
-    // Update head pointer
-    queue->head = node->next;
+    struct control_message msg;
+    msg.msg_type = msg_type;
+    msg.timestamp = olsr_clock_now();
+    msg.next_retry_time = 0;
+    msg.retry_count = 0;
+    msg.destination_id = 0;
+    msg.message_ptr = message_ptr;
     
-    // If queue is now empty, update tail
-    if (queue->head == NULL) {
-        queue->tail = NULL;
+    struct control_keyed* slot = &queue->keyed[key];
+    keyed_lock(slot);
+    int replaced = slot->pending;
+    int replaced_class = replaced ? slot->msg.msg_class : msg_class;
+    if (replaced && slot->msg.msg_class < msg_class) {
+        msg_class = slot->msg.msg_class;  // Keep the earlier message's priority
     }
+    msg.msg_class = (uint8_t)msg_class;
+    msg.deadline = msg.timestamp + class_lifetime[msg_class];
+    slot->msg = msg;
+    slot->pending = 1;
+    keyed_unlock(slot);
     
-    queue->count--;
-    
-    // Free the node (but NOT the message_ptr - caller owns it)
-    free(node);
+    if (replaced) {
+        printf("Replaced untransmitted %s in the control queue\n", class_names[replaced_class]);
+    } else {
+        __atomic_add_fetch(&queue->keyed_pushed, 1, __ATOMIC_RELAXED);
+    }
+    event_loop_wake();
+    return 0;
+}
+
+int control_queue_has_pending(struct control_queue* queue, int key) {
+    if (key < 0 || key >= CONTROL_KEY_COUNT) {
+        return 0;
+    }
+    return __atomic_load_n(&queue->keyed[key].pending, __ATOMIC_ACQUIRE);
+}
+
+size_t control_message_size(const struct control_message* msg) {
+    size_t size = sizeof(struct olsr_message);
+    if (!msg->message_ptr) {
+        return size;
+    }
+    if (msg->msg_type == MSG_HELLO) {
+        const struct olsr_hello* hello = (const struct olsr_hello*)msg->message_ptr;
+        size += sizeof(struct olsr_hello)
+              + (size_t)hello->neighbor_count * sizeof(struct hello_neighbor)
+              + (size_t)hello->two_hop_count * sizeof(struct two_hop_hello_neighbor);
+    } else if (msg->msg_type == MSG_TC) {
+        const struct olsr_tc* tc = (const struct olsr_tc*)msg->message_ptr;
+        size += sizeof(struct olsr_tc)
+              + (size_t)(tc->selector_count + tc->removed_count) * sizeof(struct tc_neighbor);
+    }
+    return size;
+}
+
+/**
+ * @brief Running state of one batch dequeue
+ */
+struct batch {
+    struct control_message* out;  /**< Caller's array */
+    int count;                    /**< Messages taken so far */
+    int max_msgs;                 /**< Message budget */
+    size_t bytes;                 /**< Estimated bytes taken so far */
+    size_t max_bytes;             /**< Byte budget, 0 for none */
+    olsr_time_t now;              /**< Clock read once for the whole batch */
+};
+
+/**
+ * @brief Check whether a message fits in what is left of the batch
+ *
+ * The first message always fits, so one larger than the whole budget is
+ * handed out alone instead of blocking its class forever.
+ *
+ * @param size Receives the message's estimated size
+ */
+static int batch_fits(const struct batch* batch, const struct control_message* msg, size_t* size) {
+    *size = 0;
+    if (batch->max_bytes == 0) {
+        return 1;
+    }
+    *size = control_message_size(msg);
+    return batch->count == 0 || batch->bytes + *size <= batch->max_bytes;
+}
+
+/**
+ * @brief Move the pending keyed messages of a class into the batch
+ * @return 1 if the batch is full (by either budget), 0 otherwise
+ */
+static int take_keyed(struct control_queue* queue, int msg_class, struct batch* batch) {
+    for (int k = 0; k < CONTROL_KEY_COUNT; k++) {
+        struct control_keyed* slot = &queue->keyed[k];
+        if (!__atomic_load_n(&slot->pending, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+        int full = 0;
+        olsr_time_t late = 0;
+        size_t size;
+        keyed_lock(slot);
+        if (slot->pending && slot->msg.msg_class == msg_class) {
+            if (batch->now > slot->msg.deadline) {
+                late = batch->now - slot->msg.deadline;
+                slot->pending = 0;
+            } else if (batch_fits(batch, &slot->msg, &size)) {
+                batch->out[batch->count++] = slot->msg;
+                batch->bytes += size;
+                slot->pending = 0;
+            } else {
+                full = 1;
+            }
+        }
+        keyed_unlock(slot);
+        if (late > 0) {
+            printf("Dropping stale %s (deadline passed %lld ms ago)\n",
+                   class_names[msg_class], (long long)late);
+        }
+        if (full || batch->count == batch->max_msgs) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Move published messages of a class ring into the batch
+ *
+ * Cells go back to the producers one by one, but head is stored once,
+ * after the last message taken.
+ *
+ * @return 1 if the batch is full (by either budget), 0 otherwise
+ */
+static int take_ring(struct control_queue* queue, int msg_class, struct batch* batch) {
+    struct control_ring* ring = &queue->rings[msg_class];
+    uint32_t pos = ring->head;  // Only the consumer moves head
+    int full = 0;
+    while (batch->count < batch->max_msgs) {
+        struct control_cell* cell = published_cell(queue, ring, pos);
+        if (!cell) {
+            break;  // Class empty
+        }
+        
+        int skip = cell->dropped;
+        if (!skip && batch->now > cell->msg.deadline) {
+            printf("Dropping stale %s (deadline passed %lld ms ago)\n",
+                   class_names[msg_class], (long long)(batch->now - cell->msg.deadline));
+            skip = 1;
+        }
+        if (!skip) {
+            size_t size;
+            if (!batch_fits(batch, &cell->msg, &size)) {
+                full = 1;  // Stays at the head for the next batch
+                break;
+            }
+            // COPY the message content to caller's buffer (caller owns message_ptr)
+            batch->out[batch->count++] = cell->msg;
+            batch->bytes += size;
+        }
+        
+        // Hand the cell back to the producers for the next lap
+        __atomic_store_n(&cell->sequence, pos + ring->mask + 1, __ATOMIC_RELEASE);
+        pos++;
+    }
+    if (pos != ring->head) {
+        __atomic_store_n(&ring->head, pos, __ATOMIC_RELEASE);
+    }
+    return full || batch->count == batch->max_msgs;
+}
+
+int pop_control_batch(struct control_queue* queue, struct control_message* out_msgs,
+                      int max_msgs, size_t max_bytes) {
+    if (!queue || !out_msgs || max_msgs <= 0) {
+        return 0;
+    }
+    struct batch batch = { out_msgs, 0, max_msgs, 0, max_bytes, olsr_clock_now() };
     
-    return 0;  // Success
+    // Strict priority: a class is only served when all higher ones are empty,
+    // so a message that does not fit ends the batch rather than being overtaken
+    for (int c = 0; c < CONTROL_CLASS_COUNT; c++) {
+        // The keyed message of a class goes before its ring
+        if (take_keyed(queue, c, &batch) || take_ring(queue, c, &batch)) {
+            break;
+        }
+    }
+    return batch.count;
+}
+
+int pop_from_control_queue(struct control_queue* queue,
+                           struct control_message* out_msg) {
+    return pop_control_batch(queue, out_msg, 1, 0) == 1 ? 0 : -1;
 }
 
 /**
  * @brief Add a message to the control queue with retry capability
- * 
+ *
  * Enhanced version of push_to_control_queue that includes retry logic
  * with exponential backoff for message retransmission.
- * 
+ *
  * @param queue Pointer to the control queue
  * @param msg_type Type of the message
  * @param message_ptr Pointer to the message structure
  * @param destination_id Destination node ID for tracking
- * @return 0 on success, -1 on failure
+ * @return 0 on success, CONTROL_QUEUE_FULL if the ring is full, -1 on other failure
  */
-int add_message_with_retry(struct control_queue* queue, uint8_t msg_type, 
+int add_message_with_retry(struct control_queue* queue, uint8_t msg_type,
                           void* message_ptr, uint32_t destination_id) {
     // Check if message pointer is valid
     if (!message_ptr) {
@@ -100,37 +490,33 @@ int add_message_with_retry(struct control_queue* queue, uint8_t msg_type,
         return -1;
     }
     
-    // Allocate new node for linked list
-    struct control_message* new_node = (struct control_message*)malloc(sizeof(struct control_message));
-    if (!new_node) {
-        printf("Error: Failed to allocate memory for control message with retry\n");
-        return -1;
+    if (queue->retry_pending >= MAX_QUEUE_SIZE) {
+        printf("Error: Retry schedule full (%d messages), retry message to dest %u rejected\n",
+               MAX_QUEUE_SIZE, destination_id);
+        return CONTROL_QUEUE_FULL;
     }
     
     // Fill in the message with retry information
-    new_node->msg_type = msg_type;
-    new_node->timestamp = time(NULL);
-    new_node->next_retry_time = new_node->timestamp + RETRY_BASE_INTERVAL;  // First retry in 2 seconds
-    new_node->retry_count = 0;
-    new_node->destination_id = destination_id;
-    new_node->message_ptr = message_ptr;  // Store pointer to message structure
-    new_node->next = NULL;
+    struct control_message msg;
+    msg.msg_type = msg_type;
+    msg.msg_class = (uint8_t)default_class(msg_type);
+    msg.timestamp = olsr_clock_now();
+    msg.deadline = msg.timestamp + class_lifetime[msg.msg_class];
+    msg.next_retry_time = msg.timestamp + RETRY_BASE_INTERVAL;  // First retry in 2 seconds
+    msg.retry_count = 0;
+    msg.destination_id = destination_id;
+    msg.message_ptr = message_ptr;  // Store pointer to message structure
     
-    // Add to linked list (append at tail)
-    if (queue->tail == NULL) {
-        // Queue is empty
-        queue->head = new_node;
-        queue->tail = new_node;
-    } else {
-        // Queue has elements, append at tail
-        queue->tail->next = new_node;
-        queue->tail = new_node;
+    int result = enqueue(queue, &msg);
+    if (result != 0) {
+        printf("Error: Control queue full (%u %s messages), retry message to dest %u rejected\n",
+               class_depth[msg.msg_class], class_names[msg.msg_class], destination_id);
+        return result;
     }
+    retry_heap_push(queue, &msg);
     
-    queue->count++;
-    
-    printf("Message queued with retry capability (dest=%u, retry_time=%ld)\n", 
-           destination_id, (long)new_node->next_retry_time);
+    printf("Message queued with retry capability (dest=%u, retry_time=%lld)\n",
+           destination_id, (long long)msg.next_retry_time);
     
     return 0;  // Success
 }
@@ -138,144 +524,109 @@ int add_message_with_retry(struct control_queue* queue, uint8_t msg_type,
 /**
  * @brief Process retry queue for message retransmissions
  * 
- * Scans the control queue for messages that are due for retry attempts.
- * Implements exponential backoff and removes messages that have exceeded
- * maximum retry attempts.
+ * Requeues every message whose retry time has passed and schedules its
+ * next retry with exponential backoff; a message that has used its
+ * MAX_RETRY_ATTEMPTS retries is dropped from the schedule. Entries that
+ * are not due are never touched.
  * 
  * @param queue Pointer to the control queue
  * @return Number of messages processed for retry
  */
 int process_retry_queue(struct control_queue* queue) {
-    if (!queue || queue->count == 0 || queue->head == NULL) {
+    if (!queue) {
         return 0;  // Nothing to process
     }
     
-    time_t now = time(NULL);
+    olsr_time_t now = olsr_clock_now();
     int processed_count = 0;
     
-    struct control_message* current = queue->head;
-    struct control_message* prev = NULL;
-    
-    // Iterate through linked list
-    while (current != NULL) {
-        struct control_message* next = current->next;  // Save next pointer
+    while (queue->retry_pending > 0 && queue->retry_heap[0].next_retry_time <= now) {
+        struct control_message current;
+        retry_heap_pop(queue, &current);
         
-        // Check if this message is due for retry
-        if (current->retry_count > 0 && now >= current->next_retry_time) {
-            
-            if (current->retry_count >= MAX_RETRY_ATTEMPTS) {
-                // Message has exceeded maximum retry attempts, remove it
-                printf("Message to dest %u exceeded max retries (%d), removing from queue\n",
-                       current->destination_id, MAX_RETRY_ATTEMPTS);
-                
-                // Remove node from list
-                if (prev == NULL) {
-                    // Removing head
-                    queue->head = next;
-                } else {
-                    prev->next = next;
-                }
-                
-                // Update tail if needed
-                if (current == queue->tail) {
-                    queue->tail = prev;
-                }
-                
-                queue->count--;
-                
-                // Free the message structure (caller is responsible for managing message_ptr)
-                free(current);
-                
-                current = next;
-                continue;
-            }
-            
-            // Calculate next retry time with exponential backoff
-            int retry_interval = RETRY_BASE_INTERVAL << current->retry_count;  // 2^retry_count
-            if (retry_interval > MAX_RETRY_INTERVAL) {
-                retry_interval = MAX_RETRY_INTERVAL;
-            }
-            
-            current->retry_count++;
-            current->next_retry_time = now + retry_interval;
-            
-            printf("Retrying message to dest %u (attempt %d/%d, next retry in %d sec)\n",
-                   current->destination_id, current->retry_count, MAX_RETRY_ATTEMPTS, retry_interval);
-            
-            processed_count++;
+        if (current.retry_count >= MAX_RETRY_ATTEMPTS) {
+            // Message has exceeded maximum retry attempts, stop retrying it
+            // (caller is responsible for managing message_ptr)
+            printf("Message to dest %u exceeded max retries (%d), removing from queue\n",
+                   current.destination_id, MAX_RETRY_ATTEMPTS);
+            continue;
+        }
+        
+        // Calculate next retry time with exponential backoff
+        olsr_time_t retry_interval = RETRY_BASE_INTERVAL << current.retry_count;  // 2^retry_count
+        if (retry_interval > MAX_RETRY_INTERVAL) {
+            retry_interval = MAX_RETRY_INTERVAL;
+        }
+        
+        current.retry_count++;
+        current.next_retry_time = now + retry_interval;
+        current.deadline = now + class_lifetime[current.msg_class];
+        
+        // Retransmit; if the ring is full this attempt is lost but still counts
+        if (enqueue(queue, &current) != 0) {
+            printf("Control queue full, retry %d to dest %u skipped\n",
+                   current.retry_count, current.destination_id);
         }
+        retry_heap_push(queue, &current);
         
-        prev = current;
-        current = next;
+        printf("Retrying message to dest %u (attempt %d/%d, next retry in %lld ms)\n",
+               current.destination_id, current.retry_count, MAX_RETRY_ATTEMPTS,
+               (long long)retry_interval);
+        
+        processed_count++;
     }
     
     return processed_count;
 }
 
 /**
- * @brief Cleanup expired messages from retry queue
- * 
- * Removes messages that have been in the queue too long or have
- * exceeded their maximum retry attempts.
- * 
+ * @brief Cleanup expired messages from the control queue
+ *
+ * Removes messages whose deadline has passed, so the cells they hold
+ * are not kept until pop reaches them. Retry limits are enforced by
+ * process_retry_queue(). Runs on the consumer side.
+ *
  * @param queue Pointer to the control queue
  * @return Number of messages cleaned up
  */
 int cleanup_expired_messages(struct control_queue* queue) {
-    if (!queue || queue->count == 0 || queue->head == NULL) {
+    if (!queue) {
         return 0;  // Nothing to cleanup
     }
     
-    time_t now = time(NULL);
+    olsr_time_t now = olsr_clock_now();
     int cleaned_count = 0;
     
-    struct control_message* current = queue->head;
-    struct control_message* prev = NULL;
-    
-    // Iterate through linked list
-    while (current != NULL) {
-        struct control_message* next = current->next;  // Save next pointer
-        
-        // Check if message should be removed
-        time_t age = now - current->timestamp;
-        int should_remove = 0;
-        
-        // Remove if too old (older than 60 seconds)
-        if (age > 60) {
-            printf("Removing expired message (age %ld sec)\n", (long)age);
-            should_remove = 1;
-        }
-        
-        // Remove if exceeded retry attempts
-        if (current->retry_count > MAX_RETRY_ATTEMPTS) {
-            printf("Removing message that exceeded retry limit\n");
-            should_remove = 1;
-        }
-        
-        if (should_remove) {
-            // Remove node from list
-            if (prev == NULL) {
-                // Removing head
-                queue->head = next;
-            } else {
-                prev->next = next;
-            }
-            
-            // Update tail if needed
-            if (current == queue->tail) {
-                queue->tail = prev;
+    // Walk the published messages of every class, oldest first
+    for (int c = 0; c < CONTROL_CLASS_COUNT; c++) {
+        struct control_ring* ring = &queue->rings[c];
+        struct control_cell* cell;
+        for (uint32_t pos = ring->head; (cell = published_cell(queue, ring, pos)) != NULL; pos++) {
+            struct control_message* current = &cell->msg;
+            if (cell->dropped || now <= current->deadline) {
+                continue;
             }
             
-            queue->count--;
+            printf("Removing expired %s (age %lld ms)\n",
+                   class_names[c], (long long)(now - current->timestamp));
+            // Pop skips it (caller manages message_ptr)
+            cell->dropped = 1;
+            cleaned_count++;
+        }
+    }
+    for (int k = 0; k < CONTROL_KEY_COUNT; k++) {
+        struct control_keyed* slot = &queue->keyed[k];
+        keyed_lock(slot);
+        int expired = slot->pending && now > slot->msg.deadline;
+        struct control_message removed = slot->msg;
+        if (expired) {
+            slot->pending = 0;
+        }
+        keyed_unlock(slot);
+        if (expired) {
+            printf("Removing expired %s (age %lld ms)\n",
+                   class_names[removed.msg_class], (long long)(now - removed.timestamp));
             cleaned_count++;
-            
-            // Free the message node (caller manages message_ptr)
-            free(current);
-            
-            current = next;
-        } else {
-            prev = current;
-            current = next;
         }
     }
     
@@ -284,4 +635,4 @@ int cleanup_expired_messages(struct control_queue* queue) {
     }
     
     return cleaned_count;
-}
\ No newline at end of file
+}
@@ -0,0 +1,155 @@
+/**
+ * @file event_loop.c
+ * @brief Blocking wait for the OLSR main loop (epoll/timerfd/eventfd)
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ */
+
+#define _DEFAULT_SOURCE  // For usleep() and the timerfd/eventfd declarations
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/event_loop.h"
+#include "../include/olsr_clock.h"
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+/** @brief epoll set watching the timer and wake descriptors */
+static int epoll_fd = -1;
+/** @brief Deadline timer */
+static int timer_fd = -1;
+/** @brief Cross-thread wake-up counter */
+static int wake_fd = -1;
+#endif
+
+/** @brief Wake-up flag used by the sleep fallback */
+static int wake_pending = 0;
+
+int event_loop_init(void) {
+#ifdef __linux__
+    if (epoll_fd != -1) {
+        return 0;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd != -1 && timer_fd != -1 && wake_fd != -1) {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = timer_fd;
+        int ok = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) == 0;
+        ev.data.fd = wake_fd;
+        ok = ok && epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev) == 0;
+        if (ok) {
+            return 0;
+        }
+    }
+
+    printf("Warning: epoll unavailable, event loop falls back to polling\n");
+    if (epoll_fd != -1) close(epoll_fd);
+    if (timer_fd != -1) close(timer_fd);
+    if (wake_fd != -1) close(wake_fd);
+    epoll_fd = timer_fd = wake_fd = -1;
+#endif
+    return -1;
+}
+
+/**
+ * @brief Consume a pending wake-up without blocking
+ * @return 1 if the loop had been woken, 0 otherwise
+ */
+static int take_wake(void) {
+    int woken = __atomic_exchange_n(&wake_pending, 0, __ATOMIC_ACQ_REL);
+#ifdef __linux__
+    uint64_t count;
+    if (wake_fd != -1 && read(wake_fd, &count, sizeof(count)) == (ssize_t)sizeof(count)) {
+        woken = 1;
+    }
+#endif
+    return woken;
+}
+
+int event_loop_wait(olsr_time_t deadline) {
+    if (olsr_clock_is_virtual()) {
+        // Simulated time: jump straight to the deadline
+        if (take_wake()) {
+            return 1;
+        }
+        olsr_clock_advance_to(deadline);
+        return 0;
+    }
+
+#ifdef __linux__
+    if (epoll_fd != -1) {
+        if (__atomic_exchange_n(&wake_pending, 0, __ATOMIC_ACQ_REL)) {
+            return 1;  // Woken before the descriptors existed
+        }
+        if (deadline <= olsr_clock_now()) {
+            return take_wake();  // A zero timerfd value would disarm it
+        }
+        struct itimerspec spec;
+        spec.it_interval.tv_sec = 0;
+        spec.it_interval.tv_nsec = 0;
+        spec.it_value.tv_sec = (time_t)(deadline / OLSR_MSEC_PER_SEC);
+        spec.it_value.tv_nsec = (long)(deadline % OLSR_MSEC_PER_SEC) * 1000000L;
+        timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+
+        int woken = 0;
+        for (;;) {
+            struct epoll_event events[2];
+            int n = epoll_wait(epoll_fd, events, 2, -1);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;  // Interrupted by a signal
+                }
+                printf("Warning: epoll_wait failed (%s), sleeping until the deadline\n",
+                       strerror(errno));
+                break;
+            }
+            int expired = 0;
+            for (int i = 0; i < n; i++) {
+                uint64_t count;
+                if (read(events[i].data.fd, &count, sizeof(count)) != (ssize_t)sizeof(count)) {
+                    continue;
+                }
+                if (events[i].data.fd == wake_fd) {
+                    woken = 1;
+                } else {
+                    expired = 1;
+                }
+            }
+            if (woken || expired) {
+                return woken;
+            }
+        }
+    }
+#endif
+
+    // Fallback: sleep in short steps so wake-ups are still noticed
+    while (!take_wake()) {
+        if (olsr_clock_now() >= deadline) {
+            return 0;
+        }
+        usleep(10000);  // 10 ms
+    }
+    return 1;
+}
+
+void event_loop_wake(void) {
+#ifdef __linux__
+    if (wake_fd != -1) {
+        uint64_t one = 1;
+        if (write(wake_fd, &one, sizeof(one)) == (ssize_t)sizeof(one)) {
+            return;
+        }
+    }
+#endif
+    __atomic_store_n(&wake_pending, 1, __ATOMIC_RELEASE);
+}
@@ -17,6 +17,9 @@
 #include "../include/olsr.h"
 #include "../include/packet.h"
 #include "../include/mpr.h"
+#include "../include/routing.h"
+#include "../include/node_index.h"
+#include "../include/timer_wheel.h"
 
 /**
  * @brief Convert a node ID to a string representation
@@ -31,114 +34,591 @@ static char *id_to_string(uint32_t id, char* buffer) {
 }
 
 /** @brief Global neighbor table array */
-struct neighbor_entry neighbor_table[MAX_NEIGHBORS];
+struct neighbor_entry* neighbor_table = NULL;
 
 /** @brief Current number of neighbors in the table */
 int neighbor_count = 0;
 
+/** @brief Allocated entries in neighbor_table */
+static int neighbor_capacity = 0;
+
+/** @brief Bumped whenever neighbor_table entries are moved, removed or reallocated */
+uint32_t neighbor_table_generation = 0;
+
 /** @brief This node's willingness to act as MPR */
 uint8_t node_willingness = WILL_DEFAULT;
 
 /** @brief This node's IP address */
 uint32_t node_id = 0;
 
-/** @brief TDMA slot reservation table for neighbors */
-static struct {
+/** @brief TDMA slot reservation of a one-hop or two-hop neighbor */
+struct slot_reservation {
     uint32_t node_id;
-    int reserved_slot;
-    time_t last_updated;
+    struct slot_set reserved_slots;
+    olsr_time_t last_updated;
     int hop_distance;  // 1 for direct neighbors, 2 for two-hop
-} neighbor_slots[MAX_NEIGHBORS + MAX_TWO_HOP_NEIGHBORS];
+};
 
+/** @brief TDMA slot reservation table for neighbors (grows on demand) */
+static struct slot_reservation* neighbor_slots = NULL;
 static int slot_table_size = 0;
+static int slot_table_capacity = 0;
+
+/**
+ * @brief Neighborhood slot occupancy, [0] for one-hop and [1] for two-hop
+ * 
+ * slot_refcount counts the reservation table entries holding each slot,
+ * and slot_occupied has the bit of every slot with a non-zero count. Both
+ * are updated as reservations are added, changed and dropped, so slot
+ * queries never scan the reservation table.
+ */
+static uint16_t slot_refcount[2][MAX_TDMA_SLOTS];
+static uint64_t slot_occupied[2][SLOT_BITMAP_WORDS];
+
+/**
+ * @brief Position in neighbor_table per interned node index
+ * 
+ * Entries are validated against the stored neighbor ID on use, so stale
+ * positions left behind by removals never need to be cleared.
+ */
+static int* neighbor_position = NULL;
+static int neighbor_position_capacity = 0;
+
+/** @brief Position in neighbor_slots per interned node index (validated on use) */
+static int* slot_position = NULL;
+static int slot_position_capacity = 0;
+
+/**
+ * @brief Record a table position for an interned node index
+ * @param positions Position array to update (grown as needed)
+ * @param capacity Current capacity of the position array
+ * @param index Interned node index
+ * @param position Table position to record
+ */
+static void set_node_position(int** positions, int* capacity, int index, int position) {
+    if (index < 0) {
+        return;
+    }
+    if (index >= *capacity) {
+        int new_capacity = *capacity > 0 ? *capacity : 64;
+        while (new_capacity <= index) {
+            new_capacity *= 2;
+        }
+        int* grown = (int*)realloc(*positions, (size_t)new_capacity * sizeof(int));
+        if (!grown) {
+            printf("Error: Failed to grow node position index\n");
+            return;
+        }
+        memset(grown + *capacity, -1, (size_t)(new_capacity - *capacity) * sizeof(int));
+        *positions = grown;
+        *capacity = new_capacity;
+    }
+    (*positions)[index] = position;
+}
+
+/**
+ * @brief Look up the recorded table position of a node
+ * @return Candidate position (must still be validated), or -1 if none
+ */
+static int get_node_position(const int* positions, int capacity, uint32_t id) {
+    int index = lookup_node_index(id);
+    if (index < 0 || index >= capacity) {
+        return -1;
+    }
+    return positions[index];
+}
+
+/**
+ * @brief Record where a neighbor lives in neighbor_table
+ * @param position Index into neighbor_table of an added or moved entry
+ */
+void index_neighbor_position(int position) {
+    set_node_position(&neighbor_position, &neighbor_position_capacity,
+                      intern_node(neighbor_table[position].neighbor_id), position);
+}
+
+/**
+ * @brief Make room for one more entry at the end of neighbor_table
+ * @return 0 on success, -1 on allocation failure
+ */
+int reserve_neighbor_entry(void) {
+    if (neighbor_count < neighbor_capacity) {
+        return 0;
+    }
+    int capacity = neighbor_capacity > 0 ? 2 * neighbor_capacity : MAX_NEIGHBORS;
+    struct neighbor_entry* grown = (struct neighbor_entry*)realloc(
+        neighbor_table, (size_t)capacity * sizeof(struct neighbor_entry));
+    if (!grown) {
+        return -1;
+    }
+    neighbor_table = grown;
+    neighbor_capacity = capacity;
+    neighbor_table_generation++;
+    return 0;
+}
+
+/**
+ * @brief Find a neighbor in the neighbor table
+ * @param addr Node ID of the neighbor
+ * @return Pointer to neighbor entry if found, NULL otherwise
+ */
+struct neighbor_entry* find_neighbor(uint32_t addr) {
+    int pos = get_node_position(neighbor_position, neighbor_position_capacity, addr);
+    if (pos < 0 || pos >= neighbor_count || neighbor_table[pos].neighbor_id != addr) {
+        return NULL;
+    }
+    return &neighbor_table[pos];
+}
 
-/** @brief This node's TDMA slot reservation */
-static int my_reserved_slot = -1;  // -1 means no reservation
+/** @brief Neighbors expired by their HELLO timers since the last check */
+static int pending_neighbor_failures = 0;
+
+/**
+ * @brief HELLO timeout timer: drop a neighbor that has gone silent
+ * 
+ * The last entry is moved into the hole; the MPR recalculation is
+ * batched in check_neighbor_timeouts().
+ */
+static void neighbor_timer_expired(uint32_t neighbor_id) {
+    struct neighbor_entry* entry = find_neighbor(neighbor_id);
+    if (!entry) {
+        return;
+    }
+    
+    olsr_time_t time_since_hello = olsr_clock_now() - entry->last_hello_time;
+    if (time_since_hello <= HELLO_TIMEOUT) {
+        refresh_neighbor_timer(entry);
+        return;
+    }
+    
+    char neighbor_str[16];
+    printf("LINK FAILURE DETECTED: Neighbor %s (timeout %lld ms > %lld ms)\n",
+           id_to_string(neighbor_id, neighbor_str),
+           (long long)time_since_hello, (long long)HELLO_TIMEOUT);
+    
+    // Handle the link failure
+    if (entry->link_status == SYM_LINK) {
+        routing_link_removed(node_id, neighbor_id);
+        mark_mpr_inputs_changed();
+    }
+    handle_link_failure(neighbor_id);
+    
+    int pos = (int)(entry - neighbor_table);
+    neighbor_count--;
+    if (pos != neighbor_count) {
+        neighbor_table[pos] = neighbor_table[neighbor_count];
+        index_neighbor_position(pos);
+        patch_hello_neighbor(pos);
+    }
+    neighbor_table_generation++;
+    pending_neighbor_failures++;
+}
+
+/**
+ * @brief (Re)arm a neighbor's HELLO timeout from its last_hello_time
+ */
+void refresh_neighbor_timer(struct neighbor_entry* entry) {
+    timer_wheel_schedule(neighbor_timer_expired, entry->neighbor_id,
+                         entry->last_hello_time + HELLO_TIMEOUT + 1);
+}
+
+/**
+ * @brief Find a node's entry in the TDMA slot reservation table
+ * @return Index into neighbor_slots, or -1 if not found
+ */
+static int find_slot_entry(uint32_t id) {
+    int pos = get_node_position(slot_position, slot_position_capacity, id);
+    if (pos < 0 || pos >= slot_table_size || neighbor_slots[pos].node_id != id) {
+        return -1;
+    }
+    return pos;
+}
+
+/**
+ * @brief Count or uncount one reservation in the occupancy bitmaps
+ * @param slot Reserved slot (ignored unless 0 <= slot < MAX_TDMA_SLOTS)
+ * @param hop_distance 1 for a direct neighbor, 2 for a two-hop neighbor
+ * @param delta +1 to add the reservation, -1 to drop it
+ */
+static void track_slot(int slot, int hop_distance, int delta) {
+    if (slot < 0 || slot >= MAX_TDMA_SLOTS) {
+        return;
+    }
+    int hop = (hop_distance == 1) ? 0 : 1;
+    uint64_t bit = 1ULL << (slot % 64);
+    if (delta > 0) {
+        if (slot_refcount[hop][slot]++ == 0) {
+            slot_occupied[hop][slot / 64] |= bit;
+        }
+    } else if (slot_refcount[hop][slot] > 0 && --slot_refcount[hop][slot] == 0) {
+        slot_occupied[hop][slot / 64] &= ~bit;
+    }
+}
+
+/**
+ * @brief Count or uncount every slot of a reservation
+ */
+static void track_slots(const struct slot_set* slots, int hop_distance, int delta) {
+    for (int slot = slot_set_first(slots); slot >= 0; slot = slot_set_next(slots, slot)) {
+        track_slot(slot, hop_distance, delta);
+    }
+}
+
+/**
+ * @brief Update the cached HELLO after a node's slot reservation changed
+ * 
+ * The slots are advertised in the two-hop/TDMA list and, for one-hop
+ * neighbors, in the neighbor's own HELLO entry.
+ */
+static void reservation_changed(uint32_t id) {
+    invalidate_hello_two_hop();
+    struct neighbor_entry* neighbor = find_neighbor(id);
+    if (neighbor) {
+        patch_hello_neighbor((int)(neighbor - neighbor_table));
+    }
+}
+
+/**
+ * @brief Drop a reservation table entry, moving the last entry into its place
+ * @param i Index into neighbor_slots
+ */
+static void remove_slot_entry(int i) {
+    uint32_t id = neighbor_slots[i].node_id;
+    track_slots(&neighbor_slots[i].reserved_slots, neighbor_slots[i].hop_distance, -1);
+    int last = --slot_table_size;
+    if (i != last) {
+        neighbor_slots[i] = neighbor_slots[last];
+        set_node_position(&slot_position, &slot_position_capacity,
+                          lookup_node_index(neighbor_slots[i].node_id), i);
+    }
+    reservation_changed(id);
+}
+
+/** @brief This node's TDMA slot reservations (empty = none) */
+static struct slot_set my_reserved_slots;
 /** @brief Global message sequence number counter */
 uint16_t message_seq_num = 0;
 
 /**
  * @brief Get this node's current reserved slot
- * @return Reserved slot number, or -1 if none
+ * @return Lowest reserved slot number, or -1 if none
  */
 int get_my_reserved_slot(void) {
-    return my_reserved_slot;
+    return slot_set_first(&my_reserved_slots);
+}
+
+/**
+ * @brief Get this node's reserved slots
+ */
+const struct slot_set* get_my_reserved_slots(void) {
+    return &my_reserved_slots;
+}
+
+/** @brief Cached HELLO message, patched as the tables it mirrors change */
+static struct olsr_hello hello_cache;
+/** @brief Cached neighbor list; entry i mirrors neighbor_table[i] */
+static struct hello_neighbor* hello_neighbors_cache = NULL;
+/** @brief Allocated entries in hello_neighbors_cache */
+static int hello_neighbors_capacity = 0;
+/** @brief Cached two-hop/TDMA list; entry i mirrors the two-hop table's entry i */
+static struct two_hop_hello_neighbor hello_two_hop_cache[MAX_TWO_HOP_NEIGHBORS];
+/** @brief Set when the cached neighbor list must be rebuilt from scratch */
+static int hello_neighbors_dirty = 1;
+/** @brief Set when the cached two-hop/TDMA list must be rebuilt from scratch */
+static int hello_two_hop_dirty = 1;
+
+/** @brief Number of HELLOs sent so far; the low 16 bits are the HELLO sequence number */
+static uint32_t hello_round = 1;
+/** @brief Delta HELLOs sent since the last full HELLO (the first HELLO is full) */
+static int hellos_since_full = HELLO_FULL_INTERVAL;
+/** @brief Sequence number of the last HELLO popped for transmission, if hello_transmitted */
+static uint16_t hello_transmitted_seq = 0;
+static int hello_transmitted = 0;
+
+/**
+ * @brief What the previous HELLO advertised about one node
+ *
+ * Indexed by node_index. A field is only meaningful while its round
+ * matches the round of the HELLO that was sent last.
+ */
+struct hello_advertised {
+    uint32_t link_round;  /**< Round that last listed the node as a neighbor */
+    uint32_t slot_round;  /**< Round that last listed the node's slot as a two-hop */
+    struct slot_set slots;      /**< Slots listed in slot_round */
+    struct slot_set link_slots; /**< Slots listed with the neighbor in link_round */
+    uint8_t link_code;    /**< Link code listed in link_round */
+};
+static struct hello_advertised* advertised = NULL;
+static int advertised_capacity = 0;
+/** @brief Neighbor IDs listed by the previous HELLO, to find removals */
+static uint32_t* advertised_neighbors = NULL;
+static int advertised_neighbor_count = 0;
+static int advertised_neighbor_capacity = 0;
+
+/** @brief Delta HELLO built from the cached one by select_hello_encoding() */
+static struct olsr_hello hello_delta;
+static struct hello_neighbor* delta_neighbors = NULL;
+static int delta_neighbors_capacity = 0;
+static struct two_hop_hello_neighbor delta_two_hop[MAX_TWO_HOP_NEIGHBORS];
+
+/**
+ * @brief Link code advertised for a neighbor
+ */
+static uint8_t hello_link_code(const struct neighbor_entry* entry) {
+    return entry->is_mpr ? MPR_NEIGH : entry->link_status;
+}
+
+/**
+ * @brief Rewrite one cached neighbor entry from neighbor_table
+ * @param position Index into neighbor_table of an added, changed or moved entry
+ */
+void patch_hello_neighbor(int position) {
+    if (hello_neighbors_dirty) {
+        return;  // Rebuilt in full on the next HELLO anyway
+    }
+    if (position >= hello_neighbors_capacity) {
+        hello_neighbors_dirty = 1;
+        return;
+    }
+    hello_neighbors_cache[position].neighbor_id = neighbor_table[position].neighbor_id;
+    hello_neighbors_cache[position].link_code = hello_link_code(&neighbor_table[position]);
+    get_neighbor_slot_reservations(neighbor_table[position].neighbor_id,
+                                   &hello_neighbors_cache[position].reserved_slots);
+}
+
+/**
+ * @brief Rewrite one cached two-hop entry from the two-hop table
+ * @param position Index into the two-hop table of an added or moved entry
+ */
+void patch_hello_two_hop(int position) {
+    if (hello_two_hop_dirty || position >= MAX_TWO_HOP_NEIGHBORS) {
+        return;  // Rebuilt later, or beyond what a HELLO carries
+    }
+    struct two_hop_neighbor* entry = &get_two_hop_table()[position];
+    hello_two_hop_cache[position].two_hop_id = entry->neighbor_id;
+    hello_two_hop_cache[position].via_neighbor_id = entry->one_hop_addr;
+    get_neighbor_slot_reservations(entry->neighbor_id, &hello_two_hop_cache[position].reserved_slots);
+}
+
+/**
+ * @brief Force the cached neighbor list to be rebuilt (e.g. MPR flags changed)
+ */
+void invalidate_hello_neighbors(void) {
+    hello_neighbors_dirty = 1;
+}
+
+/**
+ * @brief Force the cached two-hop/TDMA list to be rebuilt (e.g. a slot changed)
+ */
+void invalidate_hello_two_hop(void) {
+    hello_two_hop_dirty = 1;
 }
 
 /**
  * @brief Generate a HELLO message
  * 
- * Creates a HELLO message structure containing the node's current
- * willingness value and neighbor information. NOTE: this implementation
- * uses static storage for the returned message and for neighbor lists.
- * The returned pointer points into static buffers which are overwritten
- * on each call and must NOT be freed by the caller.
+ * Returns the cached HELLO message. Its neighbor and two-hop/TDMA lists
+ * are patched entry by entry as the neighbor, two-hop and slot tables
+ * change, and only rebuilt in full after bulk changes such as an MPR
+ * recalculation, so a periodic HELLO with no changes costs O(1).
+ * NOTE: the returned pointer points into static buffers which are
+ * updated in place and must NOT be freed by the caller.
  *
- * @return Pointer to a statically allocated HELLO message (never NULL)
+ * @return Pointer to the statically allocated HELLO message (never NULL)
  *
- * @note The returned pointer and any neighbor lists have static lifetime
- *       (valid until the next call to this function). This is intentional
- *       to avoid dynamic allocation in this build. The implementation is
- *       NOT thread-safe: concurrent calls will overwrite the same buffers.
+ * @note The returned message and its lists stay valid until the tables
+ *       they mirror next change. The implementation is NOT thread-safe.
  */
 struct olsr_hello* generate_hello_message(void) {
-    static struct olsr_hello hello_msg_static;
-    struct olsr_hello* hello_msg = &hello_msg_static;
-    memset(hello_msg, 0, sizeof(struct olsr_hello));
+    struct olsr_hello* hello_msg = &hello_cache;
+
+    if (hello_neighbors_dirty) {
+        if (neighbor_count > hello_neighbors_capacity) {
+            int capacity = hello_neighbors_capacity > 0 ? hello_neighbors_capacity : MAX_NEIGHBORS;
+            while (capacity < neighbor_count) {
+                capacity *= 2;
+            }
+            struct hello_neighbor* grown = (struct hello_neighbor*)realloc(
+                hello_neighbors_cache, (size_t)capacity * sizeof(struct hello_neighbor));
+            if (grown) {
+                hello_neighbors_cache = grown;
+                hello_neighbors_capacity = capacity;
+            }
+        }
+        int count = neighbor_count < hello_neighbors_capacity ? neighbor_count : hello_neighbors_capacity;
+        for (int i = 0; i < count; i++) {
+            hello_neighbors_cache[i].neighbor_id = neighbor_table[i].neighbor_id;
+            hello_neighbors_cache[i].link_code = hello_link_code(&neighbor_table[i]);
+            get_neighbor_slot_reservations(neighbor_table[i].neighbor_id, &hello_neighbors_cache[i].reserved_slots);
+        }
+        hello_neighbors_dirty = (count < neighbor_count);  // Retry if out of memory
+    }
+
+    int two_hop_count = get_two_hop_count();
+    if (two_hop_count > MAX_TWO_HOP_NEIGHBORS) {
+        two_hop_count = MAX_TWO_HOP_NEIGHBORS;  // HELLO carries at most this many
+    }
+    if (hello_two_hop_dirty) {
+        hello_two_hop_dirty = 0;
+        for (int i = 0; i < two_hop_count; i++) {
+            patch_hello_two_hop(i);
+        }
+    }
 
     hello_msg->hello_interval = HELLO_INTERVAL;
     hello_msg->willingness = node_willingness;
-    hello_msg->neighbor_count = neighbor_count;
-    hello_msg->reserved_slot = my_reserved_slot; // TDMA slot reservation
-
-    // One-hop neighbors (stored in a static array)
-    // neighbors_static lives in static storage and is reused on subsequent calls.
-    // Do NOT free or retain pointers across calls; they will be overwritten.
-    if (neighbor_count > 0) {
-        static struct hello_neighbor neighbors_static[MAX_NEIGHBORS];
-        hello_msg->neighbors = neighbors_static;
-        memset(hello_msg->neighbors, 0, neighbor_count * sizeof(struct hello_neighbor));
-
-        /* neighbors_static is a static buffer and cannot be NULL; fill it directly. */
-        for (int i = 0; i < neighbor_count; i++) {
-            hello_msg->neighbors[i].neighbor_id = neighbor_table[i].neighbor_id;
-            hello_msg->neighbors[i].link_code = neighbor_table[i].link_status;
+    hello_msg->reserved_slots = my_reserved_slots; // TDMA slot reservations
+    hello_msg->neighbor_count = neighbor_count < hello_neighbors_capacity ? neighbor_count : hello_neighbors_capacity;
+    hello_msg->neighbors = hello_msg->neighbor_count > 0 ? hello_neighbors_cache : NULL;
+    hello_msg->two_hop_count = (uint8_t)two_hop_count;
+    hello_msg->two_hop_neighbors = two_hop_count > 0 ? hello_two_hop_cache : NULL;
+    
+    char slots_str[SLOT_SET_STRING_LEN];
+    printf("Generated HELLO: willingness=%d, neighbors=%d, two_hop=%d, our_slots=%s\n", 
+           hello_msg->willingness, hello_msg->neighbor_count, hello_msg->two_hop_count, 
+           slot_set_format(&hello_msg->reserved_slots, slots_str));
+    
+    return hello_msg;
+}
+
+/**
+ * @brief Grow an array to hold at least count elements
+ * @return 0 on success, -1 on allocation failure
+ */
+static int reserve_array(void** array, int* capacity, int count, size_t element_size) {
+    if (count <= *capacity) {
+        return 0;
+    }
+    int new_capacity = *capacity > 0 ? *capacity : MAX_NEIGHBORS;
+    while (new_capacity < count) {
+        new_capacity *= 2;
+    }
+    void* grown = realloc(*array, (size_t)new_capacity * element_size);
+    if (!grown) {
+        return -1;
+    }
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+/**
+ * @brief Decide whether the next HELLO goes out in full or as a delta
+ *
+ * Compares the full HELLO against what the previous HELLO advertised,
+ * builds the delta from the differences and records the full HELLO as
+ * the new advertised state. The delta is used unless a periodic full
+ * HELLO is due, the delta would not be smaller, memory ran out, or the
+ * previous HELLO (the delta's base) was never popped for transmission.
+ *
+ * @param full The cached full HELLO from generate_hello_message()
+ * @return The HELLO to send: full, or the static delta HELLO
+ */
+static struct olsr_hello* select_hello_encoding(struct olsr_hello* full) {
+    uint32_t previous = hello_round++;
+    uint32_t round = hello_round;
+    int delta_ok = (reserve_array((void**)&advertised, &advertised_capacity,
+                                  get_interned_node_count() + full->neighbor_count + full->two_hop_count,
+                                  sizeof(struct hello_advertised)) == 0 &&
+                    reserve_array((void**)&delta_neighbors, &delta_neighbors_capacity,
+                                  full->neighbor_count + advertised_neighbor_count,
+                                  sizeof(struct hello_neighbor)) == 0);
+    if (!delta_ok) {
+        // Nothing can be tracked; forget the previous state so no stale entry matches
+        advertised_neighbor_count = 0;
+    }
+    
+    int changed_neighbors = 0;
+    for (int i = 0; i < full->neighbor_count; i++) {
+        int index = intern_node(full->neighbors[i].neighbor_id);
+        if (!delta_ok || index < 0 || index >= advertised_capacity) {
+            delta_ok = 0;
+            continue;
+        }
+        struct hello_advertised* entry = &advertised[index];
+        if (entry->link_round != previous || entry->link_code != full->neighbors[i].link_code ||
+            !slot_set_equal(&entry->link_slots, &full->neighbors[i].reserved_slots)) {
+            delta_neighbors[changed_neighbors++] = full->neighbors[i];
+        }
+        entry->link_round = round;
+        entry->link_code = full->neighbors[i].link_code;
+        entry->link_slots = full->neighbors[i].reserved_slots;
+    }
+    for (int i = 0; delta_ok && i < advertised_neighbor_count; i++) {
+        int index = lookup_node_index(advertised_neighbors[i]);
+        if (index >= 0 && index < advertised_capacity && advertised[index].link_round != round) {
+            delta_neighbors[changed_neighbors].neighbor_id = advertised_neighbors[i];
+            delta_neighbors[changed_neighbors].link_code = HELLO_LINK_REMOVED;
+            slot_set_clear(&delta_neighbors[changed_neighbors].reserved_slots);
+            changed_neighbors++;
         }
-    } else {
-        hello_msg->neighbors = NULL;
     }
     
-    // NEW: Two-hop neighbors with TDMA information
-    int two_hop_count = get_two_hop_count();
-    hello_msg->two_hop_count = 0;
+    int changed_two_hop = 0;
+    for (int i = 0; delta_ok && i < full->two_hop_count; i++) {
+        const struct two_hop_hello_neighbor* two_hop = &full->two_hop_neighbors[i];
+        int index = intern_node(two_hop->two_hop_id);
+        if (index < 0 || index >= advertised_capacity) {
+            delta_ok = 0;
+            break;
+        }
+        struct hello_advertised* entry = &advertised[index];
+        if (entry->slot_round == round) {
+            continue;  // Already listed via another neighbor
+        }
+        if (entry->slot_round != previous || !slot_set_equal(&entry->slots, &two_hop->reserved_slots)) {
+            delta_two_hop[changed_two_hop++] = *two_hop;
+        }
+        entry->slot_round = round;
+        entry->slots = two_hop->reserved_slots;
+    }
     
-    if (two_hop_count > 0 && two_hop_count <= MAX_TWO_HOP_NEIGHBORS) {
-        /* two_hop_static is static storage reused across calls. See note above. */
-        static struct two_hop_hello_neighbor two_hop_static[MAX_TWO_HOP_NEIGHBORS];
-        hello_msg->two_hop_neighbors = two_hop_static;
-        memset(hello_msg->two_hop_neighbors, 0, two_hop_count * sizeof(struct two_hop_hello_neighbor));
-        
-        // Get two-hop neighbor information from MPR module
-        struct two_hop_neighbor* two_hop_list = get_two_hop_table();
-        
-        for (int i = 0; i < two_hop_count && hello_msg->two_hop_count < MAX_TWO_HOP_NEIGHBORS; i++) {
-            hello_msg->two_hop_neighbors[hello_msg->two_hop_count].two_hop_id = two_hop_list[i].neighbor_id;
-            hello_msg->two_hop_neighbors[hello_msg->two_hop_count].via_neighbor_id = two_hop_list[i].one_hop_addr;
-            
-            // Get TDMA slot reservation for this two-hop neighbor
-            hello_msg->two_hop_neighbors[hello_msg->two_hop_count].reserved_slot = get_neighbor_slot_reservation(two_hop_list[i].neighbor_id);
-            
-            hello_msg->two_hop_count++;
+    // Remember who was listed, for the next HELLO's removals
+    if (reserve_array((void**)&advertised_neighbors, &advertised_neighbor_capacity,
+                      full->neighbor_count, sizeof(uint32_t)) == 0) {
+        for (int i = 0; i < full->neighbor_count; i++) {
+            advertised_neighbors[i] = full->neighbors[i].neighbor_id;
         }
+        advertised_neighbor_count = full->neighbor_count;
     } else {
-        hello_msg->two_hop_neighbors = NULL;
+        advertised_neighbor_count = 0;
+        delta_ok = 0;
     }
     
-    printf("Generated HELLO: willingness=%d, neighbors=%d, two_hop=%d, our_slot=%d\n", 
-           hello_msg->willingness, hello_msg->neighbor_count, hello_msg->two_hop_count, 
-           hello_msg->reserved_slot);
+    full->hello_seq = (uint16_t)round;
+    full->base_seq = (uint16_t)previous;
+    full->hello_type = HELLO_FULL;
     
-    return hello_msg;
+    int base_sent = hello_transmitted && hello_transmitted_seq == (uint16_t)previous;
+    if (!delta_ok || !base_sent || hellos_since_full >= HELLO_FULL_INTERVAL - 1 ||
+        changed_neighbors + changed_two_hop >= full->neighbor_count + full->two_hop_count) {
+        hellos_since_full = 0;
+        return full;
+    }
+    hellos_since_full++;
+    
+    hello_delta = *full;
+    hello_delta.hello_type = HELLO_DELTA;
+    hello_delta.neighbor_count = changed_neighbors;
+    hello_delta.neighbors = changed_neighbors > 0 ? delta_neighbors : NULL;
+    hello_delta.two_hop_count = (uint8_t)changed_two_hop;
+    hello_delta.two_hop_neighbors = changed_two_hop > 0 ? delta_two_hop : NULL;
+    return &hello_delta;
+}
+
+/**
+ * @brief Request that the next HELLO be sent in full
+ */
+void request_full_hello(void) {
+    hellos_since_full = HELLO_FULL_INTERVAL;
+}
+
+void hello_message_transmitted(const struct olsr_hello* msg) {
+    // Only this node's own HELLO (the cache or the delta) is a delta base
+    if (msg == &hello_cache || msg == &hello_delta) {
+        hello_transmitted_seq = msg->hello_seq;
+        hello_transmitted = 1;
+    }
 }
 
 /**
@@ -162,24 +642,55 @@ void send_hello_message(struct control_queue* queue) {
         printf("Error: Failed to generate HELLO message\n");
         return;
     }
+    if (control_queue_has_pending(queue, CONTROL_KEY_HELLO)) {
+        // The queued HELLO is about to be replaced unsent; a delta on top of it
+        // would reference a sequence number nobody receives
+        request_full_hello();
+    }
+    hello_msg = select_hello_encoding(hello_msg);
 
     printf("HELLO message prepared (seq=%d)\n", ++message_seq_num);
-    printf("Willingness: %d, Neighbors: %d, Slot=%d\n", 
-           hello_msg->willingness, hello_msg->neighbor_count, hello_msg->reserved_slot);
+    char slots_str[SLOT_SET_STRING_LEN];
+    printf("%s HELLO %u: Willingness: %d, Neighbors: %d, Two-hop: %d, Slots=%s\n",
+           hello_msg->hello_type == HELLO_DELTA ? "Delta" : "Full", hello_msg->hello_seq,
+           hello_msg->willingness, hello_msg->neighbor_count, hello_msg->two_hop_count,
+           slot_set_format(&hello_msg->reserved_slots, slots_str));
 
-    // Push pointer to the HELLO structure directly to the queue
-    // RRC/TDMA layer will handle serialization
-    int result = push_to_control_queue(queue, MSG_HELLO, (void*)hello_msg);
+    // Push pointer to the HELLO structure directly to the queue, replacing
+    // any HELLO still waiting there. RRC/TDMA layer will handle serialization
+    int result = push_keyed_message(queue, MSG_HELLO, (void*)hello_msg,
+                                    CONTROL_CLASS_HELLO, CONTROL_KEY_HELLO);
     if (result == 0) {
         printf("HELLO Message successfully queued for RRC/TDMA Layer\n");
     } else {
         printf("ERROR: Failed to queue HELLO Message (code=%d)\n", result);
-        // Free the message if queueing failed
-        free(hello_msg->neighbors);
-        if (hello_msg->two_hop_neighbors) {
-            free(hello_msg->two_hop_neighbors);
-        }
-        free(hello_msg);
+        // The message is the static HELLO cache or delta; nothing to free.
+        // Neighbors will never see this sequence number, so resync them.
+        request_full_hello();
+    }
+}
+
+/**
+ * @brief Record whether a neighbor selects this node as MPR
+ * @param sender Neighbor entry
+ * @param selected_as_mpr 1 if the neighbor's HELLO lists us as MPR
+ */
+static void set_mpr_selector_status(struct neighbor_entry* sender, int selected_as_mpr) {
+    uint32_t sender_id = sender->neighbor_id;
+    
+    // Update MPR selector flag
+    int was_selector = sender->is_mpr_selector;
+    sender->is_mpr_selector = selected_as_mpr;
+    
+    // Log changes
+    if (selected_as_mpr && !was_selector) {
+        char sender_str[16];
+        printf("Neighbor %s selected us as MPR\n",
+               id_to_string(sender_id, sender_str));
+    } else if (!selected_as_mpr && was_selector) {
+        char sender_str[16];
+        printf("Neighbor %s no longer selects us as MPR\n",
+               id_to_string(sender_id, sender_str));
     }
 }
 
@@ -199,6 +710,14 @@ void send_hello_message(struct control_queue* queue) {
  * 
  * See receive_and_process_message() in main.c for the complete receive path.
  * 
+ * A full HELLO replaces the two-hop entries via the sender: entries it
+ * does not list are withdrawn. A delta HELLO is applied on top of the
+ * sender's previous HELLO: listed neighbors are added, changed or
+ * (HELLO_LINK_REMOVED) withdrawn and all other two-hop entries via the
+ * sender are refreshed. If its base_seq
+ * shows a HELLO was missed, the delta only refreshes the link and the
+ * sender's entries wait for its next full HELLO.
+ * 
  * @param msg Pointer to the OLSR message containing the HELLO
  *            msg->body must point to a deserialized struct olsr_hello
  * @param sender_addr IP address of the message sender
@@ -214,64 +733,93 @@ void process_hello_message(struct olsr_message* msg, uint32_t sender_addr) {
     // Extract the deserialized HELLO message from the wrapper
     // This was already deserialized by deserialize_hello() before calling this function
     struct olsr_hello* hello_msg = (struct olsr_hello*)msg->body;
+    int is_delta = (hello_msg->hello_type == HELLO_DELTA);
     
     char sender_str[16];
-    printf("Received HELLO from %s: willingness=%d, neighbors=%d, two_hop=%d, slot=%d\n", 
-           id_to_string(sender_addr, sender_str), hello_msg->willingness, 
-           hello_msg->neighbor_count, hello_msg->two_hop_count, hello_msg->reserved_slot);
+    char slots_str[SLOT_SET_STRING_LEN];
+    printf("Received %sHELLO from %s: willingness=%d, neighbors=%d, two_hop=%d, slots=%s\n", 
+           is_delta ? "delta " : "", id_to_string(sender_addr, sender_str), hello_msg->willingness, 
+           hello_msg->neighbor_count, hello_msg->two_hop_count,
+           slot_set_format(&hello_msg->reserved_slots, slots_str));
+    
+    // Update sender's TDMA slot reservations
+    update_neighbor_slot_reservation(sender_addr, &hello_msg->reserved_slots, 1);
     
-    // Update sender's TDMA slot reservation
-    update_neighbor_slot_reservation(sender_addr, hello_msg->reserved_slot, 1);
+    // A delta only applies on top of the HELLO it was built against
+    struct neighbor_entry* known = find_neighbor(sender_addr);
+    if (is_delta && (!known || !known->hello_synced || known->hello_seq != hello_msg->base_seq)) {
+        printf("Missed HELLO from %s (delta against %u), waiting for a full HELLO\n",
+               sender_str, hello_msg->base_seq);
+        // Still proof the link is alive; keep its status until the full HELLO
+        struct neighbor_entry* sender = update_neighbor(sender_addr,
+                                                        known ? known->link_status : ASYM_LINK,
+                                                        hello_msg->willingness);
+        if (sender) {
+            sender->hello_synced = 0;
+        }
+        return;
+    }
     
     // Process two-hop neighbor TDMA information
     for (int i = 0; i < hello_msg->two_hop_count; i++) {
         uint32_t two_hop_id = hello_msg->two_hop_neighbors[i].two_hop_id;
-        int slot = hello_msg->two_hop_neighbors[i].reserved_slot;
+        const struct slot_set* slots = &hello_msg->two_hop_neighbors[i].reserved_slots;
         
         if (two_hop_id != node_id) { // Don't process info about ourselves
-            update_neighbor_slot_reservation(two_hop_id, slot, 2);
+            update_neighbor_slot_reservation(two_hop_id, slots, 2);
             
             char two_hop_str[16];
-            printf("  Two-hop via %s: Node %s using slot %d\n",
-                   sender_str, id_to_string(two_hop_id, two_hop_str), slot);
+            printf("  Two-hop via %s: Node %s using slots %s\n",
+                   sender_str, id_to_string(two_hop_id, two_hop_str), slot_set_format(slots, slots_str));
         }
     }
     
     // Check if we are mentioned in the sender's neighbor list (bidirectional link)
-    int we_are_mentioned = 0;
+    // and whether the sender selected us as MPR. A delta that does not list
+    // us leaves both as they were.
+    int we_are_mentioned = is_delta && known->link_status == SYM_LINK;
+    int selected_as_mpr = is_delta && known->is_mpr_selector;
     for (int i = 0; i < hello_msg->neighbor_count; i++) {
         if (hello_msg->neighbors[i].neighbor_id == node_id) {
-            we_are_mentioned = 1;
-            printf("We are mentioned in neighbor's HELLO message\n");
+            uint8_t link_code = hello_msg->neighbors[i].link_code;
+            we_are_mentioned = (link_code != HELLO_LINK_REMOVED);
+            selected_as_mpr = (link_code == MPR_NEIGH);
+            if (we_are_mentioned) {
+                printf("We are mentioned in neighbor's HELLO message\n");
+            }
             break;
         }
     }
-    if (we_are_mentioned) {
-        update_neighbor(sender_addr, SYM_LINK, hello_msg->willingness);
-    } else {
-        update_neighbor(sender_addr, ASYM_LINK, hello_msg->willingness);
-    }
     
-    // Update last_hello_time for timeout tracking
-    for (int i = 0; i < neighbor_count; i++) {
-        if (neighbor_table[i].neighbor_id == sender_addr) {
-            neighbor_table[i].last_hello_time = time(NULL);
-            break;
+    // Single table lookup; also refreshes last_hello_time and the timeout timer
+    struct neighbor_entry* sender = update_neighbor(sender_addr,
+                                                    we_are_mentioned ? SYM_LINK : ASYM_LINK,
+                                                    hello_msg->willingness);
+    
+    // Slots of the sender's neighbors: two hops from us, so a slot they use
+    // would collide at the sender (hidden terminal). One-hop neighbors
+    // announce their own slots.
+    for (int i = 0; i < hello_msg->neighbor_count; i++) {
+        uint32_t neighbor_id = hello_msg->neighbors[i].neighbor_id;
+        uint8_t link_code = hello_msg->neighbors[i].link_code;
+        if (link_code != HELLO_LINK_REMOVED && link_code != LOST_LINK && !find_neighbor(neighbor_id)) {
+            update_neighbor_slot_reservation(neighbor_id, &hello_msg->neighbors[i].reserved_slots, 2);
         }
     }
     
     // Extract two-hop neighbor information from HELLO message
     // Only process if sender is a symmetric neighbor
-    int sender_is_symmetric = 0;
-    for (int i = 0; i < neighbor_count; i++) {
-        if (neighbor_table[i].neighbor_id == sender_addr &&
-            neighbor_table[i].link_status == SYM_LINK) {
-            sender_is_symmetric = 1;
-            break;
-        }
-    }
+    int sender_is_symmetric = (sender && sender->link_status == SYM_LINK);
     
     if (sender_is_symmetric) {
+        if (is_delta) {
+            // Entries the delta does not mention are unchanged and still valid
+            refresh_two_hop_via_neighbor(sender_addr);
+        } else {
+            // A full HELLO lists every valid entry; the rest are withdrawn below
+            begin_two_hop_listing();
+        }
+        
         // Add all symmetric neighbors of the sender as our two-hop neighbors
         for (int i = 0; i < hello_msg->neighbor_count; i++) {
             uint32_t two_hop_addr = hello_msg->neighbors[i].neighbor_id;
@@ -282,26 +830,34 @@ void process_hello_message(struct olsr_message* msg, uint32_t sender_addr) {
             }
             
             // Skip if the two-hop neighbor is already a one-hop neighbor
-            int is_one_hop = 0;
-            for (int j = 0; j < neighbor_count; j++) {
-                if (neighbor_table[j].neighbor_id == two_hop_addr) {
-                    is_one_hop = 1;
-                    break;
-                }
-            }
+            int is_one_hop = (find_neighbor(two_hop_addr) != NULL);
             
             // Only add if symmetric link and not already one-hop
-            if (!is_one_hop && hello_msg->neighbors[i].link_code == SYM_LINK) {
+            uint8_t link_code = hello_msg->neighbors[i].link_code;
+            if (!is_one_hop && (link_code == SYM_LINK || link_code == MPR_NEIGH)) {
                 add_two_hop_neighbor(two_hop_addr, sender_addr);
+            } else if (is_delta) {
+                // Withdrawn or no longer symmetric
+                remove_two_hop_neighbor(two_hop_addr, sender_addr);
             }
         }
+        
+        if (!is_delta) {
+            // Otherwise an entry dropped from a full HELLO (or by a delta we
+            // missed) would be refreshed by every later delta and never expire
+            remove_unlisted_two_hop(sender_addr);
+        }
     }
     
-    // Recalculate MPR set after topology update
-    printf("Topology updated, recalculating MPR set...\n");
-    calculate_mpr_set();
-    update_mpr_selector_status(hello_msg, sender_addr);
-    cleanup_expired_reservations(SLOT_RESERVATION_TIMEOUT);
+    // Recalculate MPR set only if this HELLO changed its inputs
+    if (update_mpr_set() > 0) {
+        printf("MPR set changed\n");
+    }
+    if (sender) {
+        set_mpr_selector_status(sender, selected_as_mpr);
+        sender->hello_seq = hello_msg->hello_seq;
+        sender->hello_synced = 1;
+    }
     print_tdma_reservations();
 }
 
@@ -315,14 +871,8 @@ void update_mpr_selector_status(struct olsr_hello* hello_msg, uint32_t sender_id
         return;
     }
     
-    int sender_idx = -1;
-    for (int i = 0; i < neighbor_count; i++) {
-        if (neighbor_table[i].neighbor_id == sender_id) {
-            sender_idx = i;
-            break;
-        }
-    }
-    if (sender_idx == -1) {
+    struct neighbor_entry* sender = find_neighbor(sender_id);
+    if (!sender) {
         return;
     }
     
@@ -336,22 +886,10 @@ void update_mpr_selector_status(struct olsr_hello* hello_msg, uint32_t sender_id
         }
     }
     
-    // Update MPR selector flag
-    int was_selector = neighbor_table[sender_idx].is_mpr_selector;
-    neighbor_table[sender_idx].is_mpr_selector = selected_as_mpr;
-    
-    // Log changes
-    if (selected_as_mpr && !was_selector) {
-        char sender_str[16];
-        printf("Neighbor %s selected us as MPR\n",
-               id_to_string(sender_id, sender_str));
-    } else if (!selected_as_mpr && was_selector) {
-        char sender_str[16];
-        printf("Neighbor %s no longer selects us as MPR\n",
-               id_to_string(sender_id, sender_str));
-    }
+    set_mpr_selector_status(sender, selected_as_mpr);
 }
 
+
 /**
  * @brief Get count of neighbors who selected us as MPR
  * @return Number of MPR selectors
@@ -402,99 +940,194 @@ void print_neighbor_table(void) {
 }
 
 /**
- * @brief Set this node's TDMA slot reservation
- * @param slot_number TDMA slot number (-1 for no reservation)
+ * @brief Set this node's TDMA slot reservations
+ * @param slots Slots to reserve (empty to clear)
  */
-void set_my_slot_reservation(int slot_number) {
-    my_reserved_slot = slot_number;
-    if (slot_number >= 0) {
-        printf("Set my TDMA slot reservation to: %d\n", slot_number);
+void set_my_slot_reservations(const struct slot_set* slots) {
+    my_reserved_slots = *slots;
+    if (slot_set_count(slots) > 0) {
+        char slots_str[SLOT_SET_STRING_LEN];
+        printf("Set my TDMA slot reservations to: %s\n", slot_set_format(slots, slots_str));
     } else {
         printf("Cleared my TDMA slot reservation\n");
     }
 }
 
 /**
- * @brief Update neighbor's TDMA slot reservation
- * @param node_id Neighbor's node ID
+ * @brief Reserve a single TDMA slot for this node
  * @param slot_number TDMA slot number (-1 for no reservation)
+ */
+void set_my_slot_reservation(int slot_number) {
+    struct slot_set slots;
+    slot_set_clear(&slots);
+    slot_set_add(&slots, slot_number);
+    set_my_slot_reservations(&slots);
+}
+
+/**
+ * @brief Reservation timer: drop a slot reservation that was not refreshed
+ */
+static void slot_timer_expired(uint32_t id) {
+    int i = find_slot_entry(id);
+    if (i == -1) {
+        return;
+    }
+    
+    olsr_time_t now = olsr_clock_now();
+    if (now - neighbor_slots[i].last_updated <= SLOT_RESERVATION_TIMEOUT) {
+        timer_wheel_schedule(slot_timer_expired, id,
+                             neighbor_slots[i].last_updated + SLOT_RESERVATION_TIMEOUT + 1);
+        return;
+    }
+    
+    char node_str[16];
+    char slots_str[SLOT_SET_STRING_LEN];
+    printf("Expired slot reservation: Node %s (Slots %s, Age %lld ms)\n",
+           id_to_string(id, node_str), slot_set_format(&neighbor_slots[i].reserved_slots, slots_str),
+           (long long)(now - neighbor_slots[i].last_updated));
+    
+    remove_slot_entry(i);
+}
+
+/**
+ * @brief Update neighbor's TDMA slot reservations
+ * @param node_id Neighbor's node ID
+ * @param slots Reserved slots (NULL or empty for no reservation)
  * @param hop_distance 1 for direct neighbor, 2 for two-hop neighbor
  */
-void update_neighbor_slot_reservation(uint32_t neighbor_id, int slot_number, int hop_distance) {
+void update_neighbor_slot_reservation(uint32_t neighbor_id, const struct slot_set* slots, int hop_distance) {
     extern uint32_t node_id; // Reference to the global node_id
     if (neighbor_id == 0 || neighbor_id == node_id) return; // Skip invalid or self
     
-    time_t now = time(NULL);
+    struct slot_set none;
+    if (!slots) {
+        slot_set_clear(&none);
+        slots = &none;
+    }
+    olsr_time_t now = olsr_clock_now();
+    char slots_str[SLOT_SET_STRING_LEN];
     
     // Find existing entry
-    for (int i = 0; i < slot_table_size; i++) {
-        if (neighbor_slots[i].node_id == neighbor_id) {
-            neighbor_slots[i].reserved_slot = slot_number;
-            neighbor_slots[i].last_updated = now;
-            neighbor_slots[i].hop_distance = hop_distance;
-            
-            char node_str[16];
-            if (slot_number >= 0) {
-                printf("Updated slot reservation: Node %s (%d-hop) -> Slot %d\n", 
-                       id_to_string(neighbor_id, node_str), hop_distance, slot_number);
-            } else {
-                printf("Cleared slot reservation: Node %s (%d-hop)\n", 
-                       id_to_string(neighbor_id, node_str), hop_distance);
-            }
-            return;
+    int i = find_slot_entry(neighbor_id);
+    if (i != -1) {
+        int slot_changed = !slot_set_equal(&neighbor_slots[i].reserved_slots, slots);
+        if (slot_changed || neighbor_slots[i].hop_distance != hop_distance) {
+            track_slots(&neighbor_slots[i].reserved_slots, neighbor_slots[i].hop_distance, -1);
+            track_slots(slots, hop_distance, 1);
         }
-    }
-    
-    // Add new entry if space available and slot is valid
-    if (slot_table_size < MAX_NEIGHBORS + MAX_TWO_HOP_NEIGHBORS && slot_number >= 0) {
-        neighbor_slots[slot_table_size].node_id = neighbor_id;
-        neighbor_slots[slot_table_size].reserved_slot = slot_number;
-        neighbor_slots[slot_table_size].last_updated = now;
-        neighbor_slots[slot_table_size].hop_distance = hop_distance;
-        slot_table_size++;
+        neighbor_slots[i].reserved_slots = *slots;
+        neighbor_slots[i].last_updated = now;
+        neighbor_slots[i].hop_distance = hop_distance;
+        if (slot_changed) {
+            reservation_changed(neighbor_id);
+        }
+        timer_wheel_schedule(slot_timer_expired, neighbor_id, now + SLOT_RESERVATION_TIMEOUT + 1);
         
         char node_str[16];
-        printf("Added slot reservation: Node %s (%d-hop) -> Slot %d\n", 
-               id_to_string(neighbor_id, node_str), hop_distance, slot_number);
+        if (slot_set_count(slots) > 0) {
+            printf("Updated slot reservation: Node %s (%d-hop) -> Slots %s\n", 
+                   id_to_string(neighbor_id, node_str), hop_distance, slot_set_format(slots, slots_str));
+        } else {
+            printf("Cleared slot reservation: Node %s (%d-hop)\n", 
+                   id_to_string(neighbor_id, node_str), hop_distance);
+        }
+        return;
     }
+    
+    // Add new entry if any slot is reserved
+    if (slot_set_count(slots) == 0) {
+        return;
+    }
+    if (slot_table_size >= slot_table_capacity) {
+        int capacity = slot_table_capacity > 0 ? slot_table_capacity * 2 : MAX_NEIGHBORS + MAX_TWO_HOP_NEIGHBORS;
+        struct slot_reservation* grown = (struct slot_reservation*)realloc(
+            neighbor_slots, (size_t)capacity * sizeof(struct slot_reservation));
+        if (!grown) {
+            printf("Error: Failed to grow slot reservation table\n");
+            return;
+        }
+        neighbor_slots = grown;
+        slot_table_capacity = capacity;
+    }
+    neighbor_slots[slot_table_size].node_id = neighbor_id;
+    neighbor_slots[slot_table_size].reserved_slots = *slots;
+    neighbor_slots[slot_table_size].last_updated = now;
+    neighbor_slots[slot_table_size].hop_distance = hop_distance;
+    set_node_position(&slot_position, &slot_position_capacity,
+                      intern_node(neighbor_id), slot_table_size);
+    track_slots(slots, hop_distance, 1);
+    slot_table_size++;
+    timer_wheel_schedule(slot_timer_expired, neighbor_id, now + SLOT_RESERVATION_TIMEOUT + 1);
+    reservation_changed(neighbor_id);
+    
+    char node_str[16];
+    printf("Added slot reservation: Node %s (%d-hop) -> Slots %s\n", 
+           id_to_string(neighbor_id, node_str), hop_distance, slot_set_format(slots, slots_str));
 }
 
 /**
  * @brief Get neighbor's TDMA slot reservation
  * @param node_id Neighbor's node ID
- * @return Slot number, or -1 if no reservation
+ * @return Lowest reserved slot number, or -1 if no reservation
  */
 int get_neighbor_slot_reservation(uint32_t node_id) {
-    for (int i = 0; i < slot_table_size; i++) {
-        if (neighbor_slots[i].node_id == node_id) {
-            return neighbor_slots[i].reserved_slot;
-        }
+    int i = find_slot_entry(node_id);
+    if (i != -1) {
+        return slot_set_first(&neighbor_slots[i].reserved_slots);
     }
     return -1; // No reservation found
 }
 
+/**
+ * @brief Get all of a neighbor's TDMA slot reservations
+ * @param node_id Neighbor's node ID
+ * @param slots Receives the reserved slots (empty if none)
+ * @return Number of reserved slots
+ */
+int get_neighbor_slot_reservations(uint32_t node_id, struct slot_set* slots) {
+    int i = find_slot_entry(node_id);
+    if (i == -1) {
+        slot_set_clear(slots);
+        return 0;
+    }
+    *slots = neighbor_slots[i].reserved_slots;
+    return slot_set_count(slots);
+}
+
+/**
+ * @brief Get every slot in use around this node as one bitmap
+ * @param bitmap Receives SLOT_BITMAP_WORDS words: own, one-hop and two-hop slots
+ */
+static void get_occupied_bitmap(uint64_t* bitmap) {
+    for (int w = 0; w < SLOT_BITMAP_WORDS; w++) {
+        bitmap[w] = slot_occupied[0][w] | slot_occupied[1][w];
+    }
+    for (int w = 0; w < SLOT_BITMAP_WORDS; w++) {
+        bitmap[w] |= my_reserved_slots.bits[w];
+    }
+}
+
 /**
  * @brief Check if a TDMA slot is available for use
  * @param slot_number Slot number to check
- * @return 1 if available, 0 if occupied by any neighbor (1-hop or 2-hop)
+ * @return 1 if available, 0 if occupied by any neighbor (1-hop or 2-hop),
+ *         by this node, or not a valid slot
  */
 int is_slot_available(int slot_number) {
-    if (slot_number < 0) return 0;
+    if (slot_number < 0 || slot_number >= MAX_TDMA_SLOTS) return 0;
     
     // Check if we are using this slot
-    if (my_reserved_slot == slot_number) {
+    if (slot_set_has(&my_reserved_slots, slot_number)) {
         return 0; // We are using it
     }
     
     // Check if any one-hop or two-hop neighbor is using this slot
-    for (int i = 0; i < slot_table_size; i++) {
-        if (neighbor_slots[i].reserved_slot == slot_number) {
-            char node_str[16];
-            printf("Slot %d is occupied by node %s (%d-hop)\n", 
-                   slot_number, id_to_string(neighbor_slots[i].node_id, node_str),
-                   neighbor_slots[i].hop_distance);
-            return 0; // Slot occupied
-        }
+    int one_hop = slot_refcount[0][slot_number];
+    int two_hop = slot_refcount[1][slot_number];
+    if (one_hop > 0 || two_hop > 0) {
+        printf("Slot %d is occupied by %d one-hop and %d two-hop neighbor(s)\n",
+               slot_number, one_hop, two_hop);
+        return 0; // Slot occupied
     }
     
     return 1; // Slot available
@@ -502,36 +1135,78 @@ int is_slot_available(int slot_number) {
 
 /**
  * @brief Get list of occupied slots in neighborhood
- * @param occupied_slots Array to store occupied slot numbers
+ * @param occupied_slots Array to store occupied slot numbers (ascending)
  * @param max_slots Maximum slots to return
  * @return Number of occupied slots found
  */
 int get_occupied_slots(int* occupied_slots, int max_slots) {
+    uint64_t occupied[SLOT_BITMAP_WORDS];
+    get_occupied_bitmap(occupied);
+    
     int count = 0;
+    for (int w = 0; w < SLOT_BITMAP_WORDS && count < max_slots; w++) {
+        uint64_t bits = occupied[w];
+        while (bits && count < max_slots) {
+            occupied_slots[count++] = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+        }
+    }
     
-    // Add our own slot if we have one
-    if (my_reserved_slot >= 0 && count < max_slots) {
-        occupied_slots[count++] = my_reserved_slot;
-    }
-    
-    // Add neighbor slots
-    for (int i = 0; i < slot_table_size && count < max_slots; i++) {
-        if (neighbor_slots[i].reserved_slot >= 0) {
-            // Check if already in list (avoid duplicates)
-            int already_added = 0;
-            for (int j = 0; j < count; j++) {
-                if (occupied_slots[j] == neighbor_slots[i].reserved_slot) {
-                    already_added = 1;
-                    break;
-                }
-            }
-            if (!already_added) {
-                occupied_slots[count++] = neighbor_slots[i].reserved_slot;
+    return count;
+}
+
+/**
+ * @brief Count the neighbors (1-hop or 2-hop) that announce a slot
+ * @param slot_number Slot number to check
+ * @param lowest_claimant Receives the lowest claiming node ID if the count is non-zero (may be NULL)
+ * @return Number of claiming neighbors
+ */
+int count_slot_claims(int slot_number, uint32_t* lowest_claimant) {
+    if (slot_number < 0 || slot_number >= MAX_TDMA_SLOTS) {
+        return 0;
+    }
+    int claims = slot_refcount[0][slot_number] + slot_refcount[1][slot_number];
+    if (claims > 0 && lowest_claimant) {
+        // Rare (a collision), so a table scan is fine here
+        *lowest_claimant = UINT32_MAX;
+        for (int i = 0; i < slot_table_size; i++) {
+            if (slot_set_has(&neighbor_slots[i].reserved_slots, slot_number) &&
+                neighbor_slots[i].node_id < *lowest_claimant) {
+                *lowest_claimant = neighbor_slots[i].node_id;
             }
         }
     }
+    return claims;
+}
+
+/**
+ * @brief Find the lowest free TDMA slot at or after a given slot
+ * @param first_slot Slot to start searching from
+ * @return Free slot number, or -1 if every slot from first_slot on is occupied
+ */
+int find_free_slot(int first_slot) {
+    if (first_slot < 0) {
+        first_slot = 0;
+    }
+    if (first_slot >= MAX_TDMA_SLOTS) {
+        return -1;
+    }
     
-    return count;
+    uint64_t occupied[SLOT_BITMAP_WORDS];
+    get_occupied_bitmap(occupied);
+    
+    int w = first_slot / 64;
+    uint64_t free_bits = ~occupied[w] & (~0ULL << (first_slot % 64));
+    for (;;) {
+        if (free_bits) {
+            int slot = w * 64 + __builtin_ctzll(free_bits);
+            return slot < MAX_TDMA_SLOTS ? slot : -1;
+        }
+        if (++w >= SLOT_BITMAP_WORDS) {
+            return -1;
+        }
+        free_bits = ~occupied[w];
+    }
 }
 
 /**
@@ -539,23 +1214,25 @@ int get_occupied_slots(int* occupied_slots, int max_slots) {
  */
 void print_tdma_reservations(void) {
     printf("\n=== TDMA Slot Reservations ===\n");
-    printf("%-15s %-10s %-12s %-8s\n", "Node ID", "Slot", "Age (sec)", "Hops");
+    printf("%-15s %-10s %-12s %-8s\n", "Node ID", "Slots", "Age (ms)", "Hops");
     printf("------------------------------------------\n");
+    char slots_str[SLOT_SET_STRING_LEN];
     
     // Print our reservation first
-    if (my_reserved_slot >= 0) {
-        printf("%-15s %-10d %-12s %-8s\n", "THIS_NODE", my_reserved_slot, "N/A", "0");
+    if (slot_set_count(&my_reserved_slots) > 0) {
+        printf("%-15s %-10s %-12s %-8s\n", "THIS_NODE",
+               slot_set_format(&my_reserved_slots, slots_str), "N/A", "0");
     }
     
     // Print neighbor reservations
-    time_t now = time(NULL);
+    olsr_time_t now = olsr_clock_now();
     for (int i = 0; i < slot_table_size; i++) {
-        if (neighbor_slots[i].reserved_slot >= 0) {
+        if (slot_set_count(&neighbor_slots[i].reserved_slots) > 0) {
             char node_str[16];
-            printf("%-15s %-10d %-12ld %-8d\n",
+            printf("%-15s %-10s %-12lld %-8d\n",
                    id_to_string(neighbor_slots[i].node_id, node_str),
-                   neighbor_slots[i].reserved_slot,
-                   (long)(now - neighbor_slots[i].last_updated),
+                   slot_set_format(&neighbor_slots[i].reserved_slots, slots_str),
+                   (long long)(now - neighbor_slots[i].last_updated),
                    neighbor_slots[i].hop_distance);
         }
     }
@@ -565,10 +1242,15 @@ void print_tdma_reservations(void) {
 
 /**
  * @brief Clean up expired slot reservations
- * @param max_age Maximum age in seconds before expiration
+ * 
+ * Reservations normally expire through their own timers after
+ * SLOT_RESERVATION_TIMEOUT; this sweep is only needed to apply a
+ * different maximum age.
+ * 
+ * @param max_age Maximum age in milliseconds before expiration
  */
-void cleanup_expired_reservations(int max_age) {
-    time_t now = time(NULL);
+void cleanup_expired_reservations(olsr_time_t max_age) {
+    olsr_time_t now = olsr_clock_now();
     int removed_count = 0;
     
     // Compact the array by removing expired entries
@@ -578,15 +1260,19 @@ void cleanup_expired_reservations(int max_age) {
             // Keep this entry
             if (write_pos != read_pos) {
                 neighbor_slots[write_pos] = neighbor_slots[read_pos];
+                set_node_position(&slot_position, &slot_position_capacity,
+                                  lookup_node_index(neighbor_slots[write_pos].node_id), write_pos);
             }
             write_pos++;
         } else {
             // Remove this entry
+            track_slots(&neighbor_slots[read_pos].reserved_slots, neighbor_slots[read_pos].hop_distance, -1);
             char node_str[16];
-            printf("Expired slot reservation: Node %s (Slot %d, Age %ld sec)\n",
+            char slots_str[SLOT_SET_STRING_LEN];
+            printf("Expired slot reservation: Node %s (Slots %s, Age %lld ms)\n",
                    id_to_string(neighbor_slots[read_pos].node_id, node_str),
-                   neighbor_slots[read_pos].reserved_slot,
-                   (long)(now - neighbor_slots[read_pos].last_updated));
+                   slot_set_format(&neighbor_slots[read_pos].reserved_slots, slots_str),
+                   (long long)(now - neighbor_slots[read_pos].last_updated));
             removed_count++;
         }
     }
@@ -595,59 +1281,38 @@ void cleanup_expired_reservations(int max_age) {
     
     if (removed_count > 0) {
         printf("Cleaned up %d expired TDMA reservations\n", removed_count);
+        invalidate_hello_two_hop();
+        invalidate_hello_neighbors();
     }
 }
 
 /**
- * @brief Check neighbor table for expired HELLO timeouts
+ * @brief Process neighbors that failed their HELLO timeout
  * 
- * Scans the neighbor table for neighbors that haven't sent HELLO messages
- * within the timeout period (6 seconds). Removes expired neighbors and
- * triggers link failure recovery.
+ * Each neighbor has a timer that fires HELLO_TIMEOUT after its
+ * last HELLO and removes it from the table, so no sweep is needed here.
+ * This reports how many neighbors failed since the last call and
+ * updates the MPR set once if they (or expired two-hop entries)
+ * affected it.
  * 
  * @return Number of neighbors that failed timeout check
  */
 int check_neighbor_timeouts(void) {
-    time_t now = time(NULL);
-    int failed_count = 0;
-    int write_pos = 0;
-    
-    // Scan neighbor table for expired entries
-    for (int read_pos = 0; read_pos < neighbor_count; read_pos++) {
-        time_t time_since_hello = now - neighbor_table[read_pos].last_hello_time;
-        
-        if (time_since_hello > HELLO_TIMEOUT) {
-            // Neighbor has timed out
-            char neighbor_str[16];
-            printf("LINK FAILURE DETECTED: Neighbor %s (timeout %ld sec > %d sec)\n",
-                   id_to_string(neighbor_table[read_pos].neighbor_id, neighbor_str),
-                   (long)time_since_hello, HELLO_TIMEOUT);
-            
-            // Handle the link failure
-            handle_link_failure(neighbor_table[read_pos].neighbor_id);
-            failed_count++;
-            // Mark as failed in any pending messages
-        } else {
-            // Keep this neighbor (not expired)
-            if (write_pos != read_pos) {
-                neighbor_table[write_pos] = neighbor_table[read_pos];
-            }
-            write_pos++;
-        }
-    }
-    
-    // Update neighbor count after removals
-    neighbor_count = write_pos;
+    int failed_count = pending_neighbor_failures;
+    pending_neighbor_failures = 0;
     
     if (failed_count > 0) {
         printf("Removed %d failed neighbors from neighbor table\n", failed_count);
-        printf("Topology changed, recalculating MPR set...\n");
-        calculate_mpr_set();
         
         // Emergency HELLO will be generated by main loop when it detects the failure
         printf("Link failures detected - emergency HELLO will be triggered\n");
     }
     
+    // Failures and expired two-hop entries may both have changed MPR inputs
+    if (update_mpr_set() > 0) {
+        printf("MPR set changed\n");
+    }
+    
     return failed_count;
 }
 
@@ -665,7 +1330,7 @@ void handle_link_failure(uint32_t neighbor_id) {
            id_to_string(neighbor_id, neighbor_str));
     
     // Remove from TDMA slot reservations
-    update_neighbor_slot_reservation(neighbor_id, -1, 1);
+    update_neighbor_slot_reservation(neighbor_id, NULL, 1);
     
     // Remove from two-hop neighbor information via MPR module
     remove_two_hop_via_neighbor(neighbor_id);
@@ -695,19 +1360,22 @@ int generate_emergency_hello(struct control_queue* queue) {
 
     struct olsr_hello* hello_msg = generate_hello_message();
     if (!hello_msg) return -1;
+    if (control_queue_has_pending(queue, CONTROL_KEY_HELLO)) {
+        request_full_hello();  // See send_hello_message()
+    }
+    hello_msg = select_hello_encoding(hello_msg);
 
-    // Push pointer to the HELLO structure directly to the queue
-    int result = push_to_control_queue(queue, MSG_HELLO, (void*)hello_msg);
+    // Push pointer to the HELLO structure directly to the queue, ahead of
+    // queued TCs and replacing any HELLO still waiting there
+    int result = push_keyed_message(queue, MSG_HELLO, (void*)hello_msg,
+                                    CONTROL_CLASS_EMERGENCY, CONTROL_KEY_HELLO);
     if (result == 0) {
         printf("Emergency HELLO successfully queued\n");
     } else {
         printf("ERROR: Failed to queue emergency HELLO\n");
-        // Free the message if queueing failed
-        free(hello_msg->neighbors);
-        if (hello_msg->two_hop_neighbors) {
-            free(hello_msg->two_hop_neighbors);
-        }
-        free(hello_msg);
+        // The message is the static HELLO cache or delta; nothing to free.
+        // Neighbors will never see this sequence number, so resync them.
+        request_full_hello();
     }
     return result;
 }
@@ -0,0 +1,60 @@
+/**
+ * @file inbound_queue.c
+ * @brief Hand-off of received messages to the protocol loop
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ *
+ * A fixed ring guarded by a byte spinlock. The lock is held for one
+ * struct copy on push and for one batch copy on take, so the receive
+ * thread never waits behind message processing.
+ */
+
+#include <stdio.h>
+#include "../include/inbound_queue.h"
+#include "../include/event_loop.h"
+
+static struct inbound_message ring[INBOUND_QUEUE_SIZE];
+/** @brief Position of the oldest message */
+static int ring_head = 0;
+/** @brief Messages in the ring */
+static int ring_count = 0;
+static uint8_t ring_lock = 0;
+
+static void lock_ring(void) {
+    while (__atomic_test_and_set(&ring_lock, __ATOMIC_ACQUIRE)) {
+        // Held for a few struct copies at most; spin
+    }
+}
+
+static void unlock_ring(void) {
+    __atomic_clear(&ring_lock, __ATOMIC_RELEASE);
+}
+
+int inbound_queue_push(const struct inbound_message* msg) {
+    lock_ring();
+    int full = ring_count == INBOUND_QUEUE_SIZE;
+    if (!full) {
+        ring[(ring_head + ring_count) % INBOUND_QUEUE_SIZE] = *msg;
+        ring_count++;
+    }
+    unlock_ring();
+    
+    if (full) {
+        printf("Warning: Inbound queue full, dropping message type %d\n", msg->msg_type);
+        return -1;
+    }
+    event_loop_wake();
+    return 0;
+}
+
+int inbound_queue_take(struct inbound_message* out, int max) {
+    lock_ring();
+    int taken = ring_count < max ? ring_count : max;
+    for (int i = 0; i < taken; i++) {
+        out[i] = ring[(ring_head + i) % INBOUND_QUEUE_SIZE];
+    }
+    ring_head = (ring_head + taken) % INBOUND_QUEUE_SIZE;
+    ring_count -= taken;
+    unlock_ring();
+    return taken;
+}
@@ -1,4 +1,3 @@
-#define _DEFAULT_SOURCE  // For usleep()
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,6 +7,10 @@
 #include "../include/tc.h"
 #include "../include/olsr.h"
 #include "../include/routing.h"
+#include "../include/timer_wheel.h"
+#include "../include/event_loop.h"
+#include "../include/slot_alloc.h"
+#include "../include/inbound_queue.h"
 // Control queue functions are declared in olsr.h
 struct control_queue global_ctrl_queue;
 
@@ -78,7 +81,7 @@ int receive_control_message(void* message_ptr, uint8_t msg_type,
         
         struct olsr_message msg;
         msg.msg_type = MSG_TC;
-        msg.vtime = TC_VALIDITY_TIME;
+        msg.vtime = TC_VALIDITY_TIME / OLSR_MSEC_PER_SEC;
         msg.originator = originator_id;  // TC keeps original originator
         msg.ttl = ttl;
         msg.hop_count = hop_count;
@@ -104,18 +107,16 @@ int receive_control_message(void* message_ptr, uint8_t msg_type,
 void update_neighbor_from_any_message(uint32_t sender_id, uint8_t msg_type) {
     // Find existing neighbor
     int found = 0;
-    for (int i = 0; i < neighbor_count; i++) {
-        if (neighbor_table[i].neighbor_id == sender_id) {
-            // Update existing neighbor
-            neighbor_table[i].last_seen = time(NULL);
-            
-            char sender_str[16];
-            unsigned char* bytes = (unsigned char*)&sender_id;
-            snprintf(sender_str, 16, "%d.%d.%d.%d", bytes[0], bytes[1], bytes[2], bytes[3]);
-            printf("Updated neighbor %s from message type %d\n", sender_str, msg_type);
-            found = 1;
-            break;
-        }
+    struct neighbor_entry* neighbor = find_neighbor(sender_id);
+    if (neighbor) {
+        // Update existing neighbor
+        neighbor->last_seen = olsr_clock_now();
+        
+        char sender_str[16];
+        unsigned char* bytes = (unsigned char*)&sender_id;
+        snprintf(sender_str, 16, "%d.%d.%d.%d", bytes[0], bytes[1], bytes[2], bytes[3]);
+        printf("Updated neighbor %s from message type %d\n", sender_str, msg_type);
+        found = 1;
     }
     
     // If not found and it's not a control message, optionally add as new neighbor
@@ -130,11 +131,12 @@ void update_neighbor_from_any_message(uint32_t sender_id, uint8_t msg_type) {
 
 /**
  * @brief Enhanced message processing for all message types
- * Handles control messages (HELLO/TC) and data messages with routing decisions
+ * Handles control messages (HELLO/TC) and data messages with routing decisions.
+ * Runs on the protocol loop, from process_inbound_messages().
  */
-void receive_message(void* message_ptr, uint8_t msg_type, uint32_t sender_id, 
-                     uint32_t originator_id, uint32_t dest_id, uint16_t seq_num, 
-                     uint8_t ttl, uint8_t hop_count) {
+static void handle_received_message(void* message_ptr, uint8_t msg_type, uint32_t sender_id, 
+                                    uint32_t originator_id, uint32_t dest_id, uint16_t seq_num, 
+                                    uint8_t ttl, uint8_t hop_count) {
     
     printf("\n=== MESSAGE RECEIVED ===\n");
     printf("Type: %d, Sender: 0x%08X, Originator: 0x%08X, Dest: 0x%08X\n",
@@ -168,6 +170,7 @@ void receive_message(void* message_ptr, uint8_t msg_type, uint32_t sender_id,
             if (ttl > 0) {
                 printf("→ Forwarding message to next hop: 0x%08X (TTL=%d)\n", 
                        next_hop, ttl - 1);
+                slot_alloc_note_forwarded();
                 // In real implementation: forward_data_message(message_ptr, msg_type, 
                 //                        dest_id, next_hop, ttl - 1, hop_count + 1);
             } else {
@@ -191,124 +194,183 @@ void receive_message(void* message_ptr, uint8_t msg_type, uint32_t sender_id,
     
     printf("=== MESSAGE PROCESSING COMPLETE ===\n\n");
 }
+
+/**
+ * @brief Hand a received message to the protocol loop
+ * 
+ * Called by the RRC/TDMA layer on its own thread. The message is queued
+ * and processed by the protocol loop, so message_ptr must stay valid
+ * until then.
+ */
+void receive_message(void* message_ptr, uint8_t msg_type, uint32_t sender_id, 
+                     uint32_t originator_id, uint32_t dest_id, uint16_t seq_num, 
+                     uint8_t ttl, uint8_t hop_count) {
+    struct inbound_message msg;
+    msg.message_ptr = message_ptr;
+    msg.msg_type = msg_type;
+    msg.ttl = ttl;
+    msg.hop_count = hop_count;
+    msg.seq_num = seq_num;
+    msg.sender_id = sender_id;
+    msg.originator_id = originator_id;
+    msg.dest_id = dest_id;
+    inbound_queue_push(&msg);
+}
+
+/**
+ * @brief Process every message received since the last call (protocol loop only)
+ * @return Number of messages processed
+ */
+static int process_inbound_messages(void) {
+    struct inbound_message batch[INBOUND_QUEUE_SIZE];
+    int total = 0;
+    int count;
+    while ((count = inbound_queue_take(batch, INBOUND_QUEUE_SIZE)) > 0) {
+        for (int i = 0; i < count; i++) {
+            handle_received_message(batch[i].message_ptr, batch[i].msg_type, batch[i].sender_id,
+                                    batch[i].originator_id, batch[i].dest_id, batch[i].seq_num,
+                                    batch[i].ttl, batch[i].hop_count);
+        }
+        total += count;
+    }
+    return total;
+}
 void init_olsr(void){
     // Initialization code for OLSR protocol
-    struct control_queue ctrl_queue;
-    init_control_queue(&ctrl_queue);
+    // One queue for everything this node sends: its own HELLO/TC, emergency
+    // HELLOs and forwarded TCs queued while processing inbound messages
+    init_control_queue_shared(&global_ctrl_queue);
     printf("OLSR Initialized with Link Failure Detection\n");
-    struct control_message msg;
+    struct control_message batch[CONTROL_BATCH_MAX];
     
-    time_t now = time(NULL);
+    olsr_time_t now = olsr_clock_now();
     
     // Initialize timing variables
-    time_t last_hello_time = now;  // Initialize to current time
-    time_t last_tc_time = now;     // Initialize to current time  
-    time_t last_timeout_check = now;
-    time_t last_global_cleanup = now;
+    olsr_time_t last_hello_time = now;  // Initialize to current time
+    olsr_time_t last_tc_time = now;     // Initialize to current time  
+    olsr_time_t last_global_cleanup = now;
     int topology_changed = 0;
     
+    event_loop_init();
+    slot_alloc_enable(1);  // Pick a TDMA slot from the HELLO reservation data
     printf("OLSR Global Routing Loop Started\n");
     
     // Send initial HELLO and TC messages immediately for network discovery
     printf("Sending initial HELLO message for network discovery...\n");
-    send_hello_message(&ctrl_queue);
+    send_hello_message(&global_ctrl_queue);
     
     printf("Sending initial TC message for topology advertisement...\n");
-    send_tc_message(&ctrl_queue);
+    send_tc_message(&global_ctrl_queue);
     
     while(1){
-        now = time(NULL);
+        now = olsr_clock_now();
         
-        // Check for neighbor timeouts every second
-        if (now - last_timeout_check >= 1) {
-            int failed_neighbors = check_neighbor_timeouts();
-            if (failed_neighbors > 0) {
-                topology_changed = 1;
-                printf("TOPOLOGY CHANGE: %d neighbors failed timeout check\n", failed_neighbors);
-                
-                // Generate emergency HELLO after topology change
-                if (generate_emergency_hello(&ctrl_queue) == 0) {
-                    printf("Emergency HELLO generated due to topology change\n");
-                }
+        // Messages handed over by the RRC/TDMA layer since the last iteration
+        process_inbound_messages();
+        
+        // Expire soft state (neighbors, reservations, topology, duplicates)
+        if (timer_wheel_run() > 0) {
+            topology_changed = 1;
+        }
+        
+        // Neighbors dropped by their HELLO timers
+        int failed_neighbors = check_neighbor_timeouts();
+        if (failed_neighbors > 0) {
+            printf("TOPOLOGY CHANGE: %d neighbors failed timeout check\n", failed_neighbors);
+            
+            // Generate emergency HELLO after topology change
+            if (generate_emergency_hello(&global_ctrl_queue) == 0) {
+                printf("Emergency HELLO generated due to topology change\n");
             }
-            last_timeout_check = now;
         }
         
         // Process retry queue for message retransmissions
-        int retries_processed = process_retry_queue(&ctrl_queue);
+        int retries_processed = process_retry_queue(&global_ctrl_queue);
         if (retries_processed > 0) {
             printf("Processed %d message retries\n", retries_processed);
         }
 
         // Send regular HELLO messages at specified interval
         if (now - last_hello_time >= HELLO_INTERVAL) {
-            send_hello_message(&ctrl_queue);
+            slot_alloc_run(&global_ctrl_queue);
+            send_hello_message(&global_ctrl_queue);
             last_hello_time = now;
         }
         
-        // Send TC messages at specified interval (if we have MPR selectors)
-        if (now - last_tc_time >= TC_INTERVAL) {
-            send_tc_message(&ctrl_queue);
+        // Send TC messages at specified interval (if we have MPR selectors),
+        // or early when another thread asked for one
+        if (take_tc_request() || now - last_tc_time >= TC_INTERVAL) {
+            send_tc_message(&global_ctrl_queue);
             last_tc_time = now;
         }
         
-        // Process outgoing messages from control queue
-        if (pop_from_control_queue(&ctrl_queue, &msg) == 0) {
-            printf("\n--- OUTGOING MESSAGE ---\n");
-            printf("Type: %d, Message pointer: %p\n", msg.msg_type, msg.message_ptr);
-            
-            // SEND PATH: In a real implementation, this would send via MAC layer
-            // The MAC layer would handle serialization of msg.message_ptr and transmit over the network
-            
-            if (msg.msg_type == MSG_HELLO) {
-                printf("HELLO message transmitted to all neighbors\n");
-            } else if (msg.msg_type == MSG_TC) {
-                printf("TC message flooded to network (TTL=255)\n");
+        // Process all outgoing messages from control queue, one TDMA slot's worth at a time
+        int batch_count;
+        while ((batch_count = pop_control_batch(&global_ctrl_queue, batch, CONTROL_BATCH_MAX, TDMA_SLOT_BYTES)) > 0) {
+            printf("\n--- OUTGOING BATCH (%d messages) ---\n", batch_count);
+            for (int i = 0; i < batch_count; i++) {
+                struct control_message* msg = &batch[i];
+                printf("Type: %d, Message pointer: %p, %zu bytes\n",
+                       msg->msg_type, msg->message_ptr, control_message_size(msg));
+                
+                // SEND PATH: In a real implementation, this would send via MAC layer
+                // The MAC layer would handle serialization of msg->message_ptr and transmit over the network
+                
+                if (msg->msg_type == MSG_HELLO) {
+                    hello_message_transmitted((const struct olsr_hello*)msg->message_ptr);
+                    printf("HELLO message transmitted to all neighbors\n");
+                } else if (msg->msg_type == MSG_TC) {
+                    tc_message_transmitted((const struct olsr_tc*)msg->message_ptr);
+                    printf("TC message flooded to network (TTL=255)\n");
+                }
             }
-            printf("--- MESSAGE TRANSMITTED ---\n\n");
+            printf("--- BATCH TRANSMITTED ---\n\n");
         }
         
         // Global routing maintenance every 30 seconds
-        if (now - last_global_cleanup >= 30) {
+        if (now - last_global_cleanup >= OLSR_SECONDS(30)) {
             printf("\n=== GLOBAL ROUTING MAINTENANCE ===\n");
             
             // Cleanup expired control messages
-            int expired_msgs = cleanup_expired_messages(&ctrl_queue);
+            int expired_msgs = cleanup_expired_messages(&global_ctrl_queue);
             if (expired_msgs > 0) {
                 printf("Cleaned up %d expired control messages\n", expired_msgs);
             }
             
-            // Cleanup expired duplicate entries
-            int expired_dupes = cleanup_duplicate_table();
-            if (expired_dupes > 0) {
-                printf("Cleaned up %d expired duplicate entries\n", expired_dupes);
-            }
-            
-            // Cleanup expired topology links
-            int expired_links = cleanup_topology_links();
-            if (expired_links > 0) {
-                printf("Cleaned up %d expired topology links\n", expired_links);
-                topology_changed = 1;  // Recalculate routing if topology changed
-            }
-            
             printf("=== MAINTENANCE COMPLETE ===\n\n");
             last_global_cleanup = now;
         }
         
         // Recalculate routing table if topology changed
         if (topology_changed) {
-            printf("TOPOLOGY_CHANGE: Recalculating routing table\n");
-            update_routing_table();
+            printf("TOPOLOGY_CHANGE: Refreshing routing table\n");
+            refresh_routing_table();
             topology_changed = 0;
         }
         
-        // Small sleep to prevent busy waiting
-        usleep(100000);  // 100ms sleep
+        // Sleep until the next deadline or until another thread queues work
+        olsr_time_t deadline = last_hello_time + HELLO_INTERVAL;
+        if (last_tc_time + TC_INTERVAL < deadline) {
+            deadline = last_tc_time + TC_INTERVAL;
+        }
+        if (last_global_cleanup + OLSR_SECONDS(30) < deadline) {
+            deadline = last_global_cleanup + OLSR_SECONDS(30);
+        }
+        olsr_time_t timer_deadline;
+        if (timer_wheel_next_expiry(&timer_deadline) && timer_deadline < deadline) {
+            deadline = timer_deadline;
+        }
+        olsr_time_t retry_deadline;
+        if (control_queue_next_retry(&global_ctrl_queue, &retry_deadline) && retry_deadline < deadline) {
+            deadline = retry_deadline;
+        }
+        event_loop_wait(deadline);
     }
 
 }
 void simulate(){
-    init_control_queue(&global_ctrl_queue);
+    olsr_clock_use_virtual(OLSR_SECONDS(1));  // Simulated time, advanced explicitly
+    init_control_queue_shared(&global_ctrl_queue);
     printf("Control queue initialized for testing\n");
     
     send_hello_message(&global_ctrl_queue);
@@ -317,13 +379,15 @@ void simulate(){
     // Create a simple HELLO message structure for testing
     struct olsr_hello test_hello;
     memset(&test_hello, 0, sizeof(struct olsr_hello));
-    test_hello.hello_interval = 2;  // 2 second interval
+    test_hello.hello_interval = HELLO_INTERVAL;
     test_hello.willingness = 3;  // WILL_DEFAULT
+    test_hello.hello_type = HELLO_FULL;
+    test_hello.hello_seq = 0;
     test_hello.neighbor_count = 0;
     test_hello.neighbors = NULL;  // No neighbors in test message
     test_hello.two_hop_count = 0;
     test_hello.two_hop_neighbors = NULL;
-    test_hello.reserved_slot = -1;
+    slot_set_clear(&test_hello.reserved_slots);
     
     receive_control_message((void*)&test_hello, MSG_HELLO, 0xC0A80001, 0xC0A80001, 1, 1, 0);
     printf("HELLO message received and processed for testing\n");
@@ -351,18 +415,38 @@ void simulate(){
     printf("\n--- Test 1: Data message for this node ---\n");
     char test_data[] = "Hello World Data";
     receive_message((void*)test_data, 3, 0xC0A80001, 0xC0A80002, node_id, 100, 5, 2);
+    process_inbound_messages();
     
     // Test 2: Receive a data message for another node (needs forwarding)
     printf("\n--- Test 2: Data message needing forwarding ---\n");
     receive_message((void*)test_data, 3, 0xC0A80001, 0xC0A80002, 0xC0A80099, 101, 5, 2);
+    process_inbound_messages();
     
     // Test 3: Receive another HELLO to show neighbor update
     printf("\n--- Test 3: Another HELLO message (neighbor update) ---\n");
     receive_message((void*)&test_hello, MSG_HELLO, 0xC0A80001, 0xC0A80001, 0xFFFFFFFF, 2, 1, 0);
+    process_inbound_messages();
     
     // Test 4: Receive data from updated neighbor
     printf("\n--- Test 4: Data message from known neighbor ---\n");
     receive_message((void*)test_data, 3, 0xC0A80001, 0xC0A80001, node_id, 102, 5, 1);
+    process_inbound_messages();
+    
+    // Test 5: A delta HELLO built on a HELLO we never received is not applied
+    printf("\n--- Test 5: Delta HELLO after a missed HELLO ---\n");
+    test_hello.hello_type = HELLO_DELTA;
+    test_hello.hello_seq = 3;
+    test_hello.base_seq = 2;  // Only HELLO 0 was received
+    receive_message((void*)&test_hello, MSG_HELLO, 0xC0A80001, 0xC0A80001, 0xFFFFFFFF, 3, 1, 0);
+    process_inbound_messages();
+    test_hello.hello_type = HELLO_FULL;
+    
+    // Test 6: Fast-forward past the HELLO timeout so the neighbor expires
+    printf("\n--- Test 6: Neighbor timeout after fast-forward ---\n");
+    olsr_clock_advance(HELLO_TIMEOUT + OLSR_SECONDS(1));
+    timer_wheel_run();
+    check_neighbor_timeouts();
+    display_one_hop_neighbors();
     
     printf("\n=== ENHANCED MESSAGE HANDLING TEST COMPLETE ===\n");
 }
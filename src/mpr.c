@@ -12,15 +12,14 @@
 
 #include "../include/olsr.h"
 #include "../include/hello.h"
+#include "../include/node_index.h"
+#include "../include/timer_wheel.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <time.h>
 
-/** @brief Maximum number of two-hop neighbors */
-#define MAX_TWO_HOP_NEIGHBORS 100
-
 /**
  * @brief Two-hop neighbor structure
  * 
@@ -30,19 +29,64 @@
 struct two_hop_neighbor {
     uint32_t neighbor_id;      /**< IP address of the two-hop neighbor */
     uint32_t one_hop_addr;       /**< IP address of one-hop neighbor providing reach */
-    time_t last_seen;            /**< Timestamp of last update */
+    olsr_time_t last_seen;            /**< Timestamp of last update */
     struct two_hop_neighbor *next; /**< Pointer to next entry (for linked list) */
 };
 
-/** @brief Global two-hop neighbor table */
-static struct two_hop_neighbor two_hop_table[MAX_TWO_HOP_NEIGHBORS];
+/**
+ * @brief Index links of a two-hop table entry
+ *
+ * Kept in an array parallel to two_hop_table so the public entry layout
+ * stays unchanged.
+ */
+struct two_hop_links {
+    int hash_next;  /**< Next entry in the same (two-hop, via) hash chain */
+    int via_prev;   /**< Previous (less recently refreshed) entry via the same neighbor */
+    int via_next;   /**< Next (more recently refreshed) entry via the same neighbor */
+    uint32_t listed_round;  /**< two_hop_listing_round when last added or refreshed */
+};
+
+/**
+ * @brief Two-hop entries reachable through one one-hop neighbor
+ *
+ * Entries are kept in refresh order, so the head is always the next one
+ * to expire.
+ */
+struct two_hop_adjacency {
+    int head;   /**< Least recently refreshed entry, or -1 */
+    int tail;   /**< Most recently refreshed entry, or -1 */
+};
+
+/** @brief Global two-hop neighbor table (dense, unordered) */
+static struct two_hop_neighbor* two_hop_table = NULL;
+/** @brief Index links of each two-hop table entry */
+static struct two_hop_links* two_hop_links = NULL;
+/** @brief Bumped by begin_two_hop_listing() for each full HELLO applied */
+static uint32_t two_hop_listing_round = 0;
+/** @brief Allocated entries in two_hop_table (power of two) */
+static int two_hop_capacity = 0;
 /** @brief Current number of two-hop neighbors */
 static int two_hop_count = 0;
+/** @brief (two-hop, via) hash chain heads, two_hop_capacity of them */
+static int* two_hop_hash = NULL;
+
+/** @brief Adjacency list of each one-hop neighbor, indexed by node_index */
+static struct two_hop_adjacency* via_lists = NULL;
+/** @brief Allocated entries in via_lists */
+static int via_list_capacity = 0;
 
 /** @brief Array to store selected MPR addresses */
-static uint32_t mpr_set[MAX_NEIGHBORS];
+static uint32_t* mpr_set = NULL;
 /** @brief Current number of MPRs in the set */
 static int mpr_count = 0;
+/** @brief MPR set before the last recalculation, for change detection */
+static uint32_t* previous_mpr_set = NULL;
+/** @brief Allocated entries in mpr_set */
+static size_t mpr_capacity = 0;
+/** @brief Allocated entries in previous_mpr_set */
+static size_t previous_mpr_capacity = 0;
+/** @brief Set when the inputs of the MPR calculation changed since it last ran */
+static int mpr_inputs_changed = 0;
 
 /**
  * @brief Convert a node ID to a string representation
@@ -56,38 +100,258 @@ static char* id_to_string(uint32_t id, char* buffer) {
     return buffer;
 }
 
+/**
+ * @brief Hash a (two-hop, via) pair to its chain
+ */
+static unsigned int hash_two_hop(uint32_t two_hop_addr, uint32_t one_hop_addr) {
+    uint32_t h = two_hop_addr * 2654435761u ^ one_hop_addr * 2246822519u;
+    return (h ^ (h >> 15)) & (unsigned int)(two_hop_capacity - 1);
+}
+
+/**
+ * @brief Double the two-hop table and rehash
+ * @return 0 on success, -1 on allocation failure
+ */
+static int grow_two_hop_table(void) {
+    int capacity = two_hop_capacity > 0 ? 2 * two_hop_capacity : 64;
+
+    struct two_hop_neighbor* table = (struct two_hop_neighbor*)realloc(
+        two_hop_table, (size_t)capacity * sizeof(struct two_hop_neighbor));
+    if (!table) {
+        return -1;
+    }
+    two_hop_table = table;
+
+    struct two_hop_links* links = (struct two_hop_links*)realloc(
+        two_hop_links, (size_t)capacity * sizeof(struct two_hop_links));
+    if (!links) {
+        return -1;
+    }
+    two_hop_links = links;
+
+    int* heads = (int*)malloc((size_t)capacity * sizeof(int));
+    if (!heads) {
+        return -1;
+    }
+    free(two_hop_hash);
+    two_hop_hash = heads;
+    two_hop_capacity = capacity;
+    memset(two_hop_hash, -1, (size_t)capacity * sizeof(int));
+
+    for (int i = 0; i < two_hop_count; i++) {
+        unsigned int h = hash_two_hop(two_hop_table[i].neighbor_id, two_hop_table[i].one_hop_addr);
+        two_hop_links[i].hash_next = two_hop_hash[h];
+        two_hop_hash[h] = i;
+    }
+    return 0;
+}
+
+/**
+ * @brief Get the adjacency list of a one-hop neighbor
+ * @param one_hop_addr One-hop neighbor
+ * @param create Allocate the list if the neighbor has none yet
+ * @return Adjacency list, or NULL if there is none (or allocation failed)
+ */
+static struct two_hop_adjacency* get_via_list(uint32_t one_hop_addr, int create) {
+    int index = create ? intern_node(one_hop_addr) : lookup_node_index(one_hop_addr);
+    if (index < 0) {
+        return NULL;
+    }
+    if (index >= via_list_capacity) {
+        if (!create) {
+            return NULL;
+        }
+        int capacity = via_list_capacity > 0 ? via_list_capacity : 64;
+        while (capacity <= index) {
+            capacity *= 2;
+        }
+        struct two_hop_adjacency* grown = (struct two_hop_adjacency*)realloc(
+            via_lists, (size_t)capacity * sizeof(struct two_hop_adjacency));
+        if (!grown) {
+            return NULL;
+        }
+        for (int i = via_list_capacity; i < capacity; i++) {
+            grown[i].head = -1;
+            grown[i].tail = -1;
+        }
+        via_lists = grown;
+        via_list_capacity = capacity;
+    }
+    return &via_lists[index];
+}
+
+/**
+ * @brief Find a (two-hop, via) entry
+ * @return Position in two_hop_table, or -1 if not present
+ */
+static int find_two_hop(uint32_t two_hop_addr, uint32_t one_hop_addr) {
+    if (two_hop_count == 0) {
+        return -1;
+    }
+    for (int i = two_hop_hash[hash_two_hop(two_hop_addr, one_hop_addr)]; i != -1;
+         i = two_hop_links[i].hash_next) {
+        if (two_hop_table[i].neighbor_id == two_hop_addr &&
+            two_hop_table[i].one_hop_addr == one_hop_addr) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Append an entry to the tail (most recent end) of its adjacency list
+ */
+static void via_list_append(struct two_hop_adjacency* list, int pos) {
+    two_hop_links[pos].via_prev = list->tail;
+    two_hop_links[pos].via_next = -1;
+    if (list->tail != -1) {
+        two_hop_links[list->tail].via_next = pos;
+    } else {
+        list->head = pos;
+    }
+    list->tail = pos;
+}
+
+/**
+ * @brief Take an entry out of its adjacency list
+ */
+static void via_list_unlink(struct two_hop_adjacency* list, int pos) {
+    int prev = two_hop_links[pos].via_prev;
+    int next = two_hop_links[pos].via_next;
+    if (prev != -1) {
+        two_hop_links[prev].via_next = next;
+    } else {
+        list->head = next;
+    }
+    if (next != -1) {
+        two_hop_links[next].via_prev = prev;
+    } else {
+        list->tail = prev;
+    }
+}
+
+/**
+ * @brief Remove the entry at a position, filling the hole with the last entry
+ */
+static void remove_two_hop_at(int pos) {
+    struct two_hop_adjacency* list = get_via_list(two_hop_table[pos].one_hop_addr, 0);
+    via_list_unlink(list, pos);
+
+    unsigned int h = hash_two_hop(two_hop_table[pos].neighbor_id, two_hop_table[pos].one_hop_addr);
+    int* link = &two_hop_hash[h];
+    while (*link != pos) {
+        link = &two_hop_links[*link].hash_next;
+    }
+    *link = two_hop_links[pos].hash_next;
+
+    int last = --two_hop_count;
+    if (pos != last) {
+        // Move the last entry into the hole and repoint everything at it
+        two_hop_table[pos] = two_hop_table[last];
+        two_hop_links[pos] = two_hop_links[last];
+        patch_hello_two_hop(pos);
+
+        h = hash_two_hop(two_hop_table[pos].neighbor_id, two_hop_table[pos].one_hop_addr);
+        link = &two_hop_hash[h];
+        while (*link != last) {
+            link = &two_hop_links[*link].hash_next;
+        }
+        *link = pos;
+
+        struct two_hop_adjacency* moved = get_via_list(two_hop_table[pos].one_hop_addr, 0);
+        if (two_hop_links[pos].via_prev != -1) {
+            two_hop_links[two_hop_links[pos].via_prev].via_next = pos;
+        } else {
+            moved->head = pos;
+        }
+        if (two_hop_links[pos].via_next != -1) {
+            two_hop_links[two_hop_links[pos].via_next].via_prev = pos;
+        } else {
+            moved->tail = pos;
+        }
+    }
+    mpr_inputs_changed = 1;
+}
+
+/**
+ * @brief Two-hop hold timer: expire entries a neighbor no longer advertises
+ * 
+ * One timer per one-hop neighbor, due when the oldest entry via that
+ * neighbor has not been refreshed for NEIGHB_HOLD_TIME (N_HOLD_TIME).
+ */
+static void two_hop_timer_expired(uint32_t one_hop_addr) {
+    struct two_hop_adjacency* list = get_via_list(one_hop_addr, 0);
+    if (!list) {
+        return;
+    }
+    
+    olsr_time_t now = olsr_clock_now();
+    while (list->head != -1 && now - two_hop_table[list->head].last_seen > NEIGHB_HOLD_TIME) {
+        char two_hop_str[16], one_hop_str[16];
+        printf("Expired two-hop neighbor: %s via %s\n",
+               id_to_string(two_hop_table[list->head].neighbor_id, two_hop_str),
+               id_to_string(one_hop_addr, one_hop_str));
+        remove_two_hop_at(list->head);
+    }
+    
+    if (list->head != -1) {
+        timer_wheel_schedule(two_hop_timer_expired, one_hop_addr,
+                             two_hop_table[list->head].last_seen + NEIGHB_HOLD_TIME + 1);
+    }
+}
+
 /**
  * @brief Add or update a two-hop neighbor entry
  * 
  * Adds a new two-hop neighbor to the table or updates an existing one.
  * Two-hop neighbors are nodes reachable through one-hop neighbors.
+ * Entries that are not refreshed expire after NEIGHB_HOLD_TIME.
  * 
  * @param two_hop_addr IP address of the two-hop neighbor
  * @param one_hop_addr IP address of the one-hop neighbor providing reach
  * @return 0 on success, -1 on failure
  */
 int add_two_hop_neighbor(uint32_t two_hop_addr, uint32_t one_hop_addr) {
-    // Check if two-hop neighbor already exists
-    for (int i = 0; i < two_hop_count; i++) {
-        if (two_hop_table[i].neighbor_id == two_hop_addr &&
-            two_hop_table[i].one_hop_addr == one_hop_addr) {
-            // Update existing entry
-            two_hop_table[i].last_seen = time(NULL);
-            return 0;
-        }
+    struct two_hop_adjacency* list = get_via_list(one_hop_addr, 1);
+    if (!list) {
+        printf("Error: Failed to allocate two-hop adjacency list\n");
+        return -1;
+    }
+    
+    int pos = find_two_hop(two_hop_addr, one_hop_addr);
+    if (pos != -1) {
+        // Update existing entry (coverage is unchanged)
+        two_hop_table[pos].last_seen = olsr_clock_now();
+        two_hop_links[pos].listed_round = two_hop_listing_round;
+        via_list_unlink(list, pos);
+        via_list_append(list, pos);
+        return 0;
     }
     
     // Add new two-hop neighbor
-    if (two_hop_count >= MAX_TWO_HOP_NEIGHBORS) {
-        printf("Error: Two-hop neighbor table full\n");
+    if (two_hop_count >= two_hop_capacity && grow_two_hop_table() != 0) {
+        printf("Error: Failed to grow two-hop neighbor table\n");
         return -1;
     }
     
-    two_hop_table[two_hop_count].neighbor_id = two_hop_addr;
-    two_hop_table[two_hop_count].one_hop_addr = one_hop_addr;
-    two_hop_table[two_hop_count].last_seen = time(NULL);
-    two_hop_table[two_hop_count].next = NULL;
-    two_hop_count++;
+    pos = two_hop_count++;
+    two_hop_table[pos].neighbor_id = two_hop_addr;
+    two_hop_table[pos].one_hop_addr = one_hop_addr;
+    two_hop_table[pos].last_seen = olsr_clock_now();
+    two_hop_table[pos].next = NULL;
+    
+    unsigned int h = hash_two_hop(two_hop_addr, one_hop_addr);
+    two_hop_links[pos].hash_next = two_hop_hash[h];
+    two_hop_links[pos].listed_round = two_hop_listing_round;
+    two_hop_hash[h] = pos;
+    
+    if (list->head == -1) {
+        timer_wheel_schedule(two_hop_timer_expired, one_hop_addr,
+                             two_hop_table[pos].last_seen + NEIGHB_HOLD_TIME + 1);
+    }
+    via_list_append(list, pos);
+    mpr_inputs_changed = 1;
+    patch_hello_two_hop(pos);
     
     char two_hop_str[16], one_hop_str[16];
     printf("Added two-hop neighbor: %s via %s\n",
@@ -105,23 +369,17 @@ int add_two_hop_neighbor(uint32_t two_hop_addr, uint32_t one_hop_addr) {
  * @return 0 on success, -1 if not found
  */
 int remove_two_hop_neighbor(uint32_t two_hop_addr, uint32_t one_hop_addr) {
-    for (int i = 0; i < two_hop_count; i++) {
-        if (two_hop_table[i].neighbor_id == two_hop_addr &&
-            two_hop_table[i].one_hop_addr == one_hop_addr) {
-            // Shift remaining entries
-            for (int j = i; j < two_hop_count - 1; j++) {
-                two_hop_table[j] = two_hop_table[j + 1];
-            }
-            two_hop_count--;
-            
-            char two_hop_str[16], one_hop_str[16];
-            printf("Removed two-hop neighbor: %s via %s\n",
-                   id_to_string(two_hop_addr, two_hop_str),
-                   id_to_string(one_hop_addr, one_hop_str));
-            return 0;
-        }
+    int pos = find_two_hop(two_hop_addr, one_hop_addr);
+    if (pos == -1) {
+        return -1;
     }
-    return -1;
+    remove_two_hop_at(pos);
+    
+    char two_hop_str[16], one_hop_str[16];
+    printf("Removed two-hop neighbor: %s via %s\n",
+           id_to_string(two_hop_addr, two_hop_str),
+           id_to_string(one_hop_addr, one_hop_str));
+    return 0;
 }
 
 /**
@@ -129,36 +387,27 @@ int remove_two_hop_neighbor(uint32_t two_hop_addr, uint32_t one_hop_addr) {
  * 
  * When a one-hop neighbor fails, all two-hop neighbors reachable only through
  * that neighbor become unreachable and should be removed from the table.
+ * Walks only that neighbor's adjacency list.
  * 
  * @param one_hop_addr IP address of the failed one-hop neighbor
  * @return Number of two-hop neighbors removed
  */
 int remove_two_hop_via_neighbor(uint32_t one_hop_addr) {
     int removed_count = 0;
-    int write_pos = 0;
     
     char one_hop_str[16];
     printf("Removing all two-hop neighbors via failed neighbor %s\n", 
            id_to_string(one_hop_addr, one_hop_str));
     
-    // Compact the array by removing entries with matching one_hop_addr
-    for (int read_pos = 0; read_pos < two_hop_count; read_pos++) {
-        if (two_hop_table[read_pos].one_hop_addr == one_hop_addr) {
-            // Remove this entry
-            char two_hop_str[16];
-            printf("  Removed two-hop neighbor: %s\n",
-                   id_to_string(two_hop_table[read_pos].neighbor_id, two_hop_str));
-            removed_count++;
-        } else {
-            // Keep this entry
-            if (write_pos != read_pos) {
-                two_hop_table[write_pos] = two_hop_table[read_pos];
-            }
-            write_pos++;
-        }
+    struct two_hop_adjacency* list = get_via_list(one_hop_addr, 0);
+    while (list && list->head != -1) {
+        char two_hop_str[16];
+        printf("  Removed two-hop neighbor: %s\n",
+               id_to_string(two_hop_table[list->head].neighbor_id, two_hop_str));
+        remove_two_hop_at(list->head);
+        removed_count++;
     }
-    
-    two_hop_count = write_pos;
+    timer_wheel_cancel(two_hop_timer_expired, one_hop_addr);
     
     printf("Removed %d two-hop neighbors via failed neighbor %s\n", 
            removed_count, one_hop_str);
@@ -166,67 +415,298 @@ int remove_two_hop_via_neighbor(uint32_t one_hop_addr) {
     return removed_count;
 }
 
+void begin_two_hop_listing(void) {
+    two_hop_listing_round++;
+}
+
 /**
- * @brief Count how many two-hop neighbors are covered by a one-hop neighbor
+ * @brief Remove the two-hop neighbors via a one-hop neighbor that a full HELLO no longer lists
+ * 
+ * Entries listed since begin_two_hop_listing() were moved to the tail of
+ * the neighbor's adjacency list, so the unlisted ones are the entries
+ * at its head.
+ * 
+ * @param one_hop_addr IP address of the one-hop neighbor that sent the HELLO
+ * @return Number of two-hop neighbors removed
+ */
+int remove_unlisted_two_hop(uint32_t one_hop_addr) {
+    struct two_hop_adjacency* list = get_via_list(one_hop_addr, 0);
+    int removed = 0;
+    while (list && list->head != -1 &&
+           two_hop_links[list->head].listed_round != two_hop_listing_round) {
+        char two_hop_str[16], one_hop_str[16];
+        printf("Withdrawn two-hop neighbor: %s via %s\n",
+               id_to_string(two_hop_table[list->head].neighbor_id, two_hop_str),
+               id_to_string(one_hop_addr, one_hop_str));
+        remove_two_hop_at(list->head);
+        removed++;
+    }
+    if (list && list->head == -1) {
+        timer_wheel_cancel(two_hop_timer_expired, one_hop_addr);
+    }
+    return removed;
+}
+
+/**
+ * @brief Refresh every two-hop neighbor reachable via a one-hop neighbor
+ * 
+ * Used for delta HELLOs, which only list changed entries: everything the
+ * neighbor advertised before and did not withdraw is still valid.
  * 
  * @param one_hop_addr IP address of the one-hop neighbor
- * @param uncovered_only If 1, only count uncovered two-hop neighbors
- * @param covered_set Array indicating which two-hop neighbors are already covered
- * @return Number of two-hop neighbors reachable through this one-hop neighbor
+ * @return Number of two-hop neighbors refreshed
  */
-static int count_reachable_two_hop(uint32_t one_hop_addr, int uncovered_only, int* covered_set) {
-    int count = 0;
+int refresh_two_hop_via_neighbor(uint32_t one_hop_addr) {
+    struct two_hop_adjacency* list = get_via_list(one_hop_addr, 0);
+    if (!list || list->head == -1) {
+        return 0;
+    }
     
-    for (int i = 0; i < two_hop_count; i++) {
-        if (two_hop_table[i].one_hop_addr == one_hop_addr) {
-            if (!uncovered_only || !covered_set[i]) {
-                count++;
-            }
+    // All entries get the same timestamp, so the list stays in refresh order
+    olsr_time_t now = olsr_clock_now();
+    int refreshed = 0;
+    for (int pos = list->head; pos != -1; pos = two_hop_links[pos].via_next) {
+        two_hop_table[pos].last_seen = now;
+        refreshed++;
+    }
+    timer_wheel_schedule(two_hop_timer_expired, one_hop_addr, now + NEIGHB_HOLD_TIME + 1);
+    return refreshed;
+}
+
+/**
+ * @brief Per-node scratch state of one MPR calculation
+ *
+ * Indexed by node_index; entries whose stamp differs from coverage_stamp
+ * belong to an earlier calculation and are treated as empty.
+ */
+struct coverage_node {
+    uint32_t stamp;  /**< Calculation this entry belongs to */
+    int row;         /**< Coverage row of this one-hop neighbor, or -1 */
+    int column;      /**< Dense two-hop column of this node, or -1 */
+};
+
+/** @brief Per-node scratch state */
+static struct coverage_node* coverage_nodes = NULL;
+/** @brief Allocated entries in coverage_nodes */
+static int coverage_node_capacity = 0;
+/** @brief Current calculation stamp */
+static uint32_t coverage_stamp = 0;
+
+/** @brief Number of candidate paths to each two-hop column */
+static int* column_paths = NULL;
+/** @brief Allocated entries in column_paths */
+static int column_capacity = 0;
+
+/**
+ * @brief Coverage bitsets, coverage_words words per row
+ *
+ * Row r < neighbor_count holds the two-hop columns reachable through
+ * neighbor_table[r]; the two extra rows are the covered set and the set of
+ * columns with exactly one path.
+ */
+static uint64_t* coverage_bits = NULL;
+/** @brief Allocated words in coverage_bits */
+static size_t coverage_bits_capacity = 0;
+/** @brief Words per coverage row */
+static int coverage_words = 0;
+
+/**
+ * @brief Grow a scratch array to hold at least count elements
+ * @return 0 on success, -1 on allocation failure
+ */
+static int reserve_scratch(void** array, size_t* capacity, size_t count, size_t elem_size) {
+    if (count <= *capacity) {
+        return 0;
+    }
+    size_t new_capacity = *capacity > 0 ? *capacity : 64;
+    while (new_capacity < count) {
+        new_capacity *= 2;
+    }
+    void* grown = realloc(*array, new_capacity * elem_size);
+    if (!grown) {
+        return -1;
+    }
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+/**
+ * @brief Get the scratch entry of a node for the current calculation
+ *
+ * The returned pointer is only valid until the next call, which may grow
+ * the scratch array.
+ *
+ * @return Scratch entry, or NULL on allocation failure
+ */
+static struct coverage_node* coverage_node_of(uint32_t id) {
+    int index = intern_node(id);
+    if (index < 0) {
+        return NULL;
+    }
+    if (index >= coverage_node_capacity) {
+        size_t capacity = (size_t)coverage_node_capacity;
+        if (reserve_scratch((void**)&coverage_nodes, &capacity, (size_t)index + 1,
+                            sizeof(struct coverage_node)) != 0) {
+            return NULL;
         }
+        memset(coverage_nodes + coverage_node_capacity, 0,
+               (capacity - (size_t)coverage_node_capacity) * sizeof(struct coverage_node));
+        coverage_node_capacity = (int)capacity;
     }
-    
-    return count;
+    struct coverage_node* node = &coverage_nodes[index];
+    if (node->stamp != coverage_stamp) {
+        node->stamp = coverage_stamp;
+        node->row = -1;
+        node->column = -1;
+    }
+    return node;
 }
 
 /**
- * @brief Check if a one-hop neighbor is the only path to any two-hop neighbor
- * 
- * @param one_hop_addr IP address of the one-hop neighbor to check
- * @return 1 if this is the only path to at least one two-hop neighbor, 0 otherwise
+ * @brief Get a coverage row
+ */
+static uint64_t* coverage_row(int row) {
+    return coverage_bits + (size_t)row * (size_t)coverage_words;
+}
+
+/**
+ * @brief Build the coverage bitsets from the two-hop table
+ *
+ * Only symmetric neighbors that are willing to relay get a row, and only
+ * two-hop nodes reachable through such a neighbor that are neither this
+ * node nor a symmetric neighbor get a column (RFC 3626 section 8.3.1).
+ *
+ * @return Number of two-hop columns, or -1 on allocation failure
  */
-static int is_only_path(uint32_t one_hop_addr) {
+static int build_coverage(void) {
+    coverage_stamp++;
+    if (coverage_stamp == 0) {
+        // Stamp wrapped: forget every earlier calculation
+        memset(coverage_nodes, 0, (size_t)coverage_node_capacity * sizeof(struct coverage_node));
+        coverage_stamp = 1;
+    }
+
+    for (int i = 0; i < neighbor_count; i++) {
+        struct coverage_node* node = coverage_node_of(neighbor_table[i].neighbor_id);
+        if (!node) {
+            return -1;
+        }
+        if (neighbor_table[i].link_status == SYM_LINK) {
+            node->row = neighbor_table[i].willingness != WILL_NEVER ? i : -2;
+        }
+    }
+    struct coverage_node* self = coverage_node_of(node_id);
+    if (!self) {
+        return -1;
+    }
+    self->row = -2;  // Never a two-hop column
+
+    // Assign dense columns and count the candidate paths to each
+    int columns = 0;
     for (int i = 0; i < two_hop_count; i++) {
-        uint32_t two_hop = two_hop_table[i].neighbor_id;
-        
-        // Count how many one-hop neighbors can reach this two-hop neighbor
-        int path_count = 0;
-        for (int j = 0; j < two_hop_count; j++) {
-            if (two_hop_table[j].neighbor_id == two_hop) {
-                path_count++;
+        struct coverage_node* via = coverage_node_of(two_hop_table[i].one_hop_addr);
+        if (!via) {
+            return -1;
+        }
+        int via_row = via->row;
+        struct coverage_node* target = coverage_node_of(two_hop_table[i].neighbor_id);
+        if (!target) {
+            return -1;
+        }
+        if (via_row < 0 || target->row != -1) {
+            continue;  // Not a usable path, or the target is one hop away
+        }
+        if (target->column < 0) {
+            size_t capacity = (size_t)column_capacity;
+            if (reserve_scratch((void**)&column_paths, &capacity, (size_t)columns + 1,
+                                sizeof(int)) != 0) {
+                return -1;
             }
+            column_capacity = (int)capacity;
+            target->column = columns;
+            column_paths[columns++] = 0;
         }
-        
-        // If this one-hop neighbor provides the only path
-        if (path_count == 1 && two_hop_table[i].one_hop_addr == one_hop_addr) {
+        column_paths[target->column]++;
+    }
+
+    coverage_words = (columns + 63) / 64;
+    size_t words = (size_t)(neighbor_count + 2) * (size_t)coverage_words;
+    if (reserve_scratch((void**)&coverage_bits, &coverage_bits_capacity, words,
+                        sizeof(uint64_t)) != 0) {
+        return -1;
+    }
+    if (words > 0) {
+        memset(coverage_bits, 0, words * sizeof(uint64_t));
+    }
+
+    // Table entries are unique, so each one adds a distinct path
+    for (int i = 0; i < two_hop_count; i++) {
+        int via_row = coverage_node_of(two_hop_table[i].one_hop_addr)->row;
+        int column = coverage_node_of(two_hop_table[i].neighbor_id)->column;
+        if (via_row < 0 || column < 0) {
+            continue;
+        }
+        coverage_row(via_row)[column / 64] |= (uint64_t)1 << (column % 64);
+    }
+
+    uint64_t* unique = coverage_row(neighbor_count + 1);
+    for (int c = 0; c < columns; c++) {
+        if (column_paths[c] == 1) {
+            unique[c / 64] |= (uint64_t)1 << (c % 64);
+        }
+    }
+    return columns;
+}
+
+/**
+ * @brief Count the uncovered two-hop nodes a neighbor would cover
+ *
+ * @param row Coverage row of the neighbor
+ * @return Number of columns in the row that are not covered yet
+ */
+static int count_new_coverage(int row) {
+    const uint64_t* bits = coverage_row(row);
+    const uint64_t* covered = coverage_row(neighbor_count);
+    int count = 0;
+    for (int w = 0; w < coverage_words; w++) {
+        count += __builtin_popcountll(bits[w] & ~covered[w]);
+    }
+    return count;
+}
+
+/**
+ * @brief Check if a neighbor is the only path to any two-hop node
+ *
+ * @param row Coverage row of the neighbor
+ * @return 1 if some column of the row has exactly one path, 0 otherwise
+ */
+static int is_only_path(int row) {
+    const uint64_t* bits = coverage_row(row);
+    const uint64_t* unique = coverage_row(neighbor_count + 1);
+    for (int w = 0; w < coverage_words; w++) {
+        if (bits[w] & unique[w]) {
             return 1;
         }
     }
-    
     return 0;
 }
 
 /**
- * @brief Mark two-hop neighbors as covered by a selected MPR
- * 
- * @param one_hop_addr IP address of the MPR one-hop neighbor
- * @param covered_set Array to mark covered two-hop neighbors
+ * @brief Add a neighbor's two-hop nodes to the covered set
+ *
+ * @param row Coverage row of the selected MPR
+ * @return Number of newly covered two-hop nodes
  */
-static void mark_covered_two_hop(uint32_t one_hop_addr, int* covered_set) {
-    for (int i = 0; i < two_hop_count; i++) {
-        if (two_hop_table[i].one_hop_addr == one_hop_addr) {
-            covered_set[i] = 1;
-        }
+static int mark_covered_two_hop(int row) {
+    const uint64_t* bits = coverage_row(row);
+    uint64_t* covered = coverage_row(neighbor_count);
+    int count = 0;
+    for (int w = 0; w < coverage_words; w++) {
+        count += __builtin_popcountll(bits[w] & ~covered[w]);
+        covered[w] |= bits[w];
     }
+    return count;
 }
 
 /**
@@ -239,19 +719,33 @@ static void mark_covered_two_hop(uint32_t one_hop_addr, int* covered_set) {
  * 4. Select neighbors that reach the most uncovered two-hop neighbors
  * 5. Continue until all two-hop neighbors are covered
  * 
+ * Coverage is held as one bitset per neighbor over dense two-hop columns,
+ * so each test is a few word-wide AND/popcount operations.
+ * 
  * @return 0 on success, -1 on failure
  */
 int calculate_mpr_set(void) {
     printf("\n=== Starting MPR Calculation ===\n");
     
+    // Every MPR is a neighbor, so the set never outgrows the neighbor table
+    // Both arrays must fit before mpr_count can grow; update_mpr_set()
+    // copies mpr_count entries from one to the other
+    if (reserve_scratch((void**)&mpr_set, &mpr_capacity, (size_t)neighbor_count,
+                        sizeof(uint32_t)) != 0 ||
+        reserve_scratch((void**)&previous_mpr_set, &previous_mpr_capacity, (size_t)neighbor_count,
+                        sizeof(uint32_t)) != 0) {
+        printf("Error: Failed to grow MPR set\n");
+        return -1;
+    }
+    
     // Clear current MPR set
     mpr_count = 0;
-    memset(mpr_set, 0, sizeof(mpr_set));
     
     // Mark all neighbors as non-MPR initially
     for (int i = 0; i < neighbor_count; i++) {
         neighbor_table[i].is_mpr = 0;
     }
+    invalidate_hello_neighbors();  // Advertised link codes follow is_mpr
     
     // If no two-hop neighbors, no MPRs needed
     if (two_hop_count == 0) {
@@ -259,8 +753,12 @@ int calculate_mpr_set(void) {
         return 0;
     }
     
-    // Array to track which two-hop neighbors are covered
-    int covered_set[MAX_TWO_HOP_NEIGHBORS] = {0};
+    int columns = build_coverage();
+    if (columns < 0) {
+        printf("Error: Failed to allocate MPR coverage sets\n");
+        return -1;
+    }
+    int uncovered = columns;
     
     // Step 1: Select all neighbors with willingness WILL_ALWAYS
     for (int i = 0; i < neighbor_count; i++) {
@@ -269,7 +767,7 @@ int calculate_mpr_set(void) {
             
             mpr_set[mpr_count++] = neighbor_table[i].neighbor_id;
             neighbor_table[i].is_mpr = 1;
-            mark_covered_two_hop(neighbor_table[i].neighbor_id, covered_set);
+            uncovered -= mark_covered_two_hop(i);
             
             char addr_str[16];
             printf("Selected MPR (WILL_ALWAYS): %s\n",
@@ -283,10 +781,10 @@ int calculate_mpr_set(void) {
             !neighbor_table[i].is_mpr &&
             neighbor_table[i].willingness != WILL_NEVER) {
             
-            if (is_only_path(neighbor_table[i].neighbor_id)) {
+            if (is_only_path(i)) {
                 mpr_set[mpr_count++] = neighbor_table[i].neighbor_id;
                 neighbor_table[i].is_mpr = 1;
-                mark_covered_two_hop(neighbor_table[i].neighbor_id, covered_set);
+                uncovered -= mark_covered_two_hop(i);
                 
                 char addr_str[16];
                 printf("Selected MPR (only path): %s\n",
@@ -296,22 +794,7 @@ int calculate_mpr_set(void) {
     }
     
     // Step 3: Select neighbors based on reachability and willingness
-    int all_covered = 0;
-    while (!all_covered) {
-        all_covered = 1;
-        
-        // Check if all two-hop neighbors are covered
-        for (int i = 0; i < two_hop_count; i++) {
-            if (!covered_set[i]) {
-                all_covered = 0;
-                break;
-            }
-        }
-        
-        if (all_covered) {
-            break;
-        }
-        
+    while (uncovered > 0) {
         // Find neighbor that covers most uncovered two-hop neighbors
         int best_neighbor_idx = -1;
         int max_new_coverage = 0;
@@ -322,12 +805,11 @@ int calculate_mpr_set(void) {
                 !neighbor_table[i].is_mpr &&
                 neighbor_table[i].willingness != WILL_NEVER) {
                 
-                int new_coverage = count_reachable_two_hop(
-                    neighbor_table[i].neighbor_id, 1, covered_set);
+                int new_coverage = count_new_coverage(i);
                 
                 // Select neighbor with most coverage, or highest willingness if tied
                 if (new_coverage > max_new_coverage ||
-                    (new_coverage == max_new_coverage && 
+                    (new_coverage > 0 && new_coverage == max_new_coverage && 
                      neighbor_table[i].willingness > best_willingness)) {
                     max_new_coverage = new_coverage;
                     best_neighbor_idx = i;
@@ -340,7 +822,7 @@ int calculate_mpr_set(void) {
         if (best_neighbor_idx >= 0) {
             mpr_set[mpr_count++] = neighbor_table[best_neighbor_idx].neighbor_id;
             neighbor_table[best_neighbor_idx].is_mpr = 1;
-            mark_covered_two_hop(neighbor_table[best_neighbor_idx].neighbor_id, covered_set);
+            uncovered -= mark_covered_two_hop(best_neighbor_idx);
             
             char addr_str[16];
             printf("Selected MPR (coverage=%d, will=%d): %s\n",
@@ -358,6 +840,49 @@ int calculate_mpr_set(void) {
     return 0;
 }
 
+/**
+ * @brief Flag the MPR calculation inputs as changed
+ */
+void mark_mpr_inputs_changed(void) {
+    mpr_inputs_changed = 1;
+}
+
+/**
+ * @brief Recalculate the MPR set only if its inputs changed
+ * 
+ * @return 1 if the MPR set changed, 0 if it did not (or nothing changed
+ *         since the last calculation), -1 on failure
+ */
+int update_mpr_set(void) {
+    if (!mpr_inputs_changed) {
+        return 0;
+    }
+    
+    int previous_count = mpr_count;
+    if (previous_count > 0) {
+        memcpy(previous_mpr_set, mpr_set, (size_t)previous_count * sizeof(uint32_t));
+    }
+    
+    if (calculate_mpr_set() != 0) {
+        return -1;  // Inputs stay flagged so the next call retries
+    }
+    mpr_inputs_changed = 0;
+    
+    if (mpr_count != previous_count) {
+        return 1;
+    }
+    for (int i = 0; i < previous_count; i++) {
+        int kept = 0;
+        for (int j = 0; j < mpr_count && !kept; j++) {
+            kept = (mpr_set[j] == previous_mpr_set[i]);
+        }
+        if (!kept) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 /**
  * @brief Get the current MPR set
  * 
@@ -452,11 +977,11 @@ void print_two_hop_table(void) {
  */
 void clear_mpr_set(void) {
     mpr_count = 0;
-    memset(mpr_set, 0, sizeof(mpr_set));
     
     for (int i = 0; i < neighbor_count; i++) {
         neighbor_table[i].is_mpr = 0;
     }
+    invalidate_hello_neighbors();
     
     printf("MPR set cleared\n");
 }
@@ -467,8 +992,18 @@ void clear_mpr_set(void) {
  * Removes all entries from the two-hop neighbor table.
  */
 void clear_two_hop_table(void) {
+    if (two_hop_count > 0) {
+        mpr_inputs_changed = 1;
+    }
     two_hop_count = 0;
-    memset(two_hop_table, 0, sizeof(two_hop_table));
+    if (two_hop_hash) {
+        memset(two_hop_hash, -1, (size_t)two_hop_capacity * sizeof(int));
+    }
+    // Hold timers left armed find empty lists and do nothing
+    for (int i = 0; i < via_list_capacity; i++) {
+        via_lists[i].head = -1;
+        via_lists[i].tail = -1;
+    }
     
     printf("Two-hop neighbor table cleared\n");
 }
@@ -484,7 +1019,11 @@ int get_two_hop_count(void) {
 
 /**
  * @brief Get pointer to two-hop neighbor table
- * @return Pointer to two-hop neighbor table array
+ * 
+ * The table is dense but unordered, and the pointer is only valid until
+ * the table next changes.
+ * 
+ * @return Pointer to two-hop neighbor table array (get_two_hop_count() entries)
  */
 struct two_hop_neighbor* get_two_hop_table(void) {
     return two_hop_table;
@@ -22,40 +22,63 @@ static char* id_to_string(uint32_t id, char* buffer) {
     return buffer;
 }
 
-void update_neighbor(uint32_t neighbor_id, int link_type, uint8_t willingness){
+struct neighbor_entry* update_neighbor(uint32_t neighbor_id, int link_type, uint8_t willingness){
     // First try to update existing neighbor
-    for (int i = 0; i < neighbor_count; i++) {
-        if (neighbor_table[i].neighbor_id == neighbor_id) {
-            neighbor_table[i].link_status = link_type;
-            neighbor_table[i].willingness = willingness;
-            neighbor_table[i].last_seen = time(NULL);
-            neighbor_table[i].last_hello_time = time(NULL);  // Initialize for timeout tracking
-            char addr_str[16];
-            printf("Updated neighbor: %s (link_type=%d, willingness=%d)\n",
-                   id_to_string(neighbor_id, addr_str),
-                   link_type, willingness);
-            return;
+    struct neighbor_entry* entry = find_neighbor(neighbor_id);
+    if (entry) {
+        int was_symmetric = (entry->link_status == SYM_LINK);
+        if (was_symmetric != (link_type == SYM_LINK) ||
+            (was_symmetric && entry->willingness != willingness)) {
+            mark_mpr_inputs_changed();
+        }
+        if (entry->link_status != link_type) {
+            entry->link_status = link_type;
+            patch_hello_neighbor((int)(entry - neighbor_table));
+        }
+        entry->willingness = willingness;
+        entry->last_seen = olsr_clock_now();
+        entry->last_hello_time = olsr_clock_now();  // Initialize for timeout tracking
+        refresh_neighbor_timer(entry);
+        char addr_str[16];
+        printf("Updated neighbor: %s (link_type=%d, willingness=%d)\n",
+               id_to_string(neighbor_id, addr_str),
+               link_type, willingness);
+        
+        // Keep the shortest path tree in step with the direct links
+        if (!was_symmetric && link_type == SYM_LINK) {
+            routing_link_added(node_id, neighbor_id);
+        } else if (was_symmetric && link_type != SYM_LINK) {
+            routing_link_removed(node_id, neighbor_id);
         }
+        return entry;
     }
     
-    // If neighbor doesn't exist, add it
-    add_neighbor(neighbor_id, (uint8_t)link_type, willingness);
+    // If neighbor doesn't exist, add it (at the end of the table)
+    if (add_neighbor(neighbor_id, (uint8_t)link_type, willingness) != 0) {
+        return NULL;
+    }
+    return &neighbor_table[neighbor_count - 1];
 }
 
 int add_neighbor(uint32_t neighbor_id, uint8_t link_code, uint8_t willingness){
-    if (neighbor_count >= MAX_NEIGHBORS) {
-        printf("Error: Neighbor table full\n");
+    if (reserve_neighbor_entry() != 0) {
+        printf("Error: Failed to grow neighbor table\n");
         return -1;
     }
     
     neighbor_table[neighbor_count].neighbor_id = neighbor_id;
     neighbor_table[neighbor_count].link_status = link_code;
     neighbor_table[neighbor_count].willingness = willingness;
-    neighbor_table[neighbor_count].last_seen = time(NULL);
-    neighbor_table[neighbor_count].last_hello_time = time(NULL);  // Initialize for timeout tracking
+    neighbor_table[neighbor_count].last_seen = olsr_clock_now();
+    neighbor_table[neighbor_count].last_hello_time = olsr_clock_now();  // Initialize for timeout tracking
     neighbor_table[neighbor_count].is_mpr = 0;
     neighbor_table[neighbor_count].is_mpr_selector = 0;
+    neighbor_table[neighbor_count].hello_seq = 0;
+    neighbor_table[neighbor_count].hello_synced = 0;  // Wait for a full HELLO
     neighbor_table[neighbor_count].next = NULL;
+    index_neighbor_position(neighbor_count);
+    refresh_neighbor_timer(&neighbor_table[neighbor_count]);
+    patch_hello_neighbor(neighbor_count);
     
     neighbor_count++;
     
@@ -64,6 +87,11 @@ int add_neighbor(uint32_t neighbor_id, uint8_t link_code, uint8_t willingness){
            id_to_string(neighbor_id, addr_str),
            link_code, willingness);
     
+    if (link_code == SYM_LINK) {
+        routing_link_added(node_id, neighbor_id);
+        mark_mpr_inputs_changed();
+    }
+    
     return 0;
 }
 
@@ -88,7 +116,7 @@ void display_one_hop_neighbors(void) {
            "Neighbor ID", "Link Status", "Willingness", "Is MPR", "MPR Sel", "Last Seen");
     printf("----------------------------------------\n");
     
-    time_t current_time = time(NULL);
+    olsr_time_t current_time = olsr_clock_now();
     char addr_str[16];
     
     for (int i = 0; i < neighbor_count; i++) {
@@ -101,9 +129,9 @@ void display_one_hop_neighbors(void) {
             default: link_status_str = "UNKNOWN"; break;
         }
         
-        int time_since_seen = (int)(current_time - neighbor_table[i].last_seen);
+        long long time_since_seen = (long long)(current_time - neighbor_table[i].last_seen);
         
-        printf("%-15s %-12s %-10d %-8s %-8s %ds ago\n",
+        printf("%-15s %-12s %-10d %-8s %-8s %lld ms ago\n",
                id_to_string(neighbor_table[i].neighbor_id, addr_str),
                link_status_str,
                neighbor_table[i].willingness,
@@ -142,13 +170,13 @@ void display_two_hop_neighbors(void) {
            "Two-Hop ID", "Via One-Hop", "Last Seen");
     printf("----------------------------------------\n");
     
-    time_t current_time = time(NULL);
+    olsr_time_t current_time = olsr_clock_now();
     char two_hop_str[16], one_hop_str[16];
     
     for (int i = 0; i < count; i++) {
-        int time_since_seen = (int)(current_time - two_hop_table[i].last_seen);
+        long long time_since_seen = (long long)(current_time - two_hop_table[i].last_seen);
         
-        printf("%-15s %-15s %ds ago\n",
+        printf("%-15s %-15s %lld ms ago\n",
                id_to_string(two_hop_table[i].neighbor_id, two_hop_str),
                id_to_string(two_hop_table[i].one_hop_addr, one_hop_str),
                time_since_seen);
@@ -0,0 +1,138 @@
+/**
+ * @file node_index.c
+ * @brief Node ID interning implementation
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ *
+ * Node IDs are kept in a dense array in interning order and found through
+ * an open-addressed hash table with linear probing. The table is kept at
+ * most half full and rebuilt when it grows, so lookups are O(1).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../include/node_index.h"
+
+/** @brief Dense index -> node ID */
+static uint32_t* node_ids = NULL;
+/** @brief Number of interned nodes */
+static int node_count = 0;
+/** @brief Allocated entries in node_ids */
+static int node_capacity = 0;
+
+/** @brief Hash slots holding dense indices (-1 = empty) */
+static int* index_map = NULL;
+/** @brief Number of hash slots (power of two) */
+static int map_capacity = 0;
+
+/**
+ * @brief Hash a node ID to its home slot
+ */
+static unsigned int hash_slot(uint32_t node_id) {
+    return (node_id * 2654435761u) & (unsigned int)(map_capacity - 1);
+}
+
+/**
+ * @brief Grow storage so that one more node can be interned
+ * @return 0 on success, -1 on allocation failure
+ */
+static int grow_storage(void) {
+    int capacity = node_capacity > 0 ? 2 * node_capacity : 64;
+
+    // Keep the hash table at most half full. Allocate it first, so a
+    // failure leaves node_capacity matching the map we still have
+    int* map = NULL;
+    if (map_capacity < 2 * capacity) {
+        map = (int*)malloc((size_t)(2 * capacity) * sizeof(int));
+        if (!map) {
+            return -1;
+        }
+    }
+
+    uint32_t* ids = (uint32_t*)realloc(node_ids, (size_t)capacity * sizeof(uint32_t));
+    if (!ids) {
+        free(map);
+        return -1;
+    }
+    node_ids = ids;
+    node_capacity = capacity;
+
+    if (map) {
+        free(index_map);
+        index_map = map;
+        map_capacity = 2 * capacity;
+        memset(index_map, -1, (size_t)map_capacity * sizeof(int));
+
+        for (int i = 0; i < node_count; i++) {
+            unsigned int slot = hash_slot(node_ids[i]);
+            while (index_map[slot] != -1) {
+                slot = (slot + 1) & (unsigned int)(map_capacity - 1);
+            }
+            index_map[slot] = i;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Get the dense index of a node without assigning one
+ */
+int lookup_node_index(uint32_t node_id) {
+    if (map_capacity == 0) {
+        return -1;
+    }
+
+    unsigned int slot = hash_slot(node_id);
+    while (index_map[slot] != -1) {
+        int index = index_map[slot];
+        if (node_ids[index] == node_id) {
+            return index;
+        }
+        slot = (slot + 1) & (unsigned int)(map_capacity - 1);
+    }
+    return -1;
+}
+
+/**
+ * @brief Get the dense index of a node, assigning one if the node is new
+ */
+int intern_node(uint32_t node_id) {
+    int index = lookup_node_index(node_id);
+    if (index != -1) {
+        return index;
+    }
+
+    if (node_count >= node_capacity && grow_storage() != 0) {
+        printf("Error: Failed to grow node index table\n");
+        return -1;
+    }
+
+    unsigned int slot = hash_slot(node_id);
+    while (index_map[slot] != -1) {
+        slot = (slot + 1) & (unsigned int)(map_capacity - 1);
+    }
+
+    index = node_count++;
+    node_ids[index] = node_id;
+    index_map[slot] = index;
+    return index;
+}
+
+/**
+ * @brief Get the node ID behind a dense index
+ */
+uint32_t node_id_of(int index) {
+    if (index < 0 || index >= node_count) {
+        return 0;
+    }
+    return node_ids[index];
+}
+
+/**
+ * @brief Get the number of interned nodes
+ */
+int get_interned_node_count(void) {
+    return node_count;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file olsr_clock.c
+ * @brief Monotonic and virtual clock backends
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ */
+
+#define _POSIX_C_SOURCE 199309L  // For clock_gettime()
+#include <stdint.h>
+#include <time.h>
+#include "../include/olsr_clock.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/** @brief Set while the virtual backend is active */
+static int clock_virtual = 0;
+/** @brief Current virtual time */
+static olsr_time_t virtual_now = 0;
+
+/**
+ * @brief Read the system monotonic clock
+ */
+static olsr_time_t monotonic_now(void) {
+#ifdef _WIN32
+    return (olsr_time_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (olsr_time_t)ts.tv_sec * OLSR_MSEC_PER_SEC + ts.tv_nsec / 1000000;
+#endif
+}
+
+olsr_time_t olsr_clock_now(void) {
+    return clock_virtual ? virtual_now : monotonic_now();
+}
+
+void olsr_clock_use_monotonic(void) {
+    clock_virtual = 0;
+}
+
+void olsr_clock_use_virtual(olsr_time_t start) {
+    clock_virtual = 1;
+    virtual_now = start > 0 ? start : 1;
+}
+
+int olsr_clock_is_virtual(void) {
+    return clock_virtual;
+}
+
+void olsr_clock_advance(olsr_time_t delta) {
+    if (clock_virtual && delta > 0) {
+        virtual_now += delta;
+    }
+}
+
+void olsr_clock_advance_to(olsr_time_t when) {
+    if (clock_virtual && when > virtual_now) {
+        virtual_now = when;
+    }
+}
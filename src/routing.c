@@ -13,259 +13,1253 @@
 #include <string.h>
 #include <stdint.h>
 #include <time.h>
+#include <sched.h>
 #include "../include/olsr.h"
 #include "../include/packet.h"
 #include "../include/hello.h"
 #include "../include/routing.h"
+#include "../include/node_index.h"
+#include "../include/timer_wheel.h"
 
-// Global topology database - always enabled
-struct global_topology_entry {
-    uint32_t from_node;
-    uint32_t to_node;
-    uint16_t ansn;
-    time_t validity_time;
+/**
+ * @brief Topology set advertised by one TC originator
+ * 
+ * Holds the originator's last accepted ANSN and advertised neighbor set.
+ * All links of a set come from the same TC message and share its
+ * validity time, so a newer ANSN replaces the set as a whole.
+ */
+struct topology_set {
+    uint32_t* targets;    /**< Advertised neighbor IDs (no duplicates) */
+    int count;            /**< Number of advertised neighbors */
+    int capacity;         /**< Allocated entries in targets */
+    uint16_t ansn;        /**< ANSN of the accepted advertisement */
+    olsr_time_t validity_time; /**< When the set expires */
 };
 
-static struct duplicate_entry duplicate_table[MAX_DUPLICATE_ENTRIES];
-static int duplicate_count = 0;
-static struct global_topology_entry global_topology[MAX_TOPOLOGY_LINKS];
-static int global_topology_count = 0;
+// Duplicate detection windows, indexed by interned originator
+static struct duplicate_entry* duplicate_windows = NULL;
+static int duplicate_capacity = 0;
+
+// Global topology database, indexed by interned originator
+static struct topology_set* topology_sets = NULL;
+static int topology_set_capacity = 0;
+static int topology_link_count = 0;
+// Per-node marks for diffing advertised sets without clearing between updates
+static uint32_t* topology_mark = NULL;
+static int topology_mark_capacity = 0;
+static uint32_t topology_stamp = 0;
+
+/**
+ * @brief Grow a per-node array so that index is valid, zero-filling new entries
+ * @return 0 on success, -1 on allocation failure
+ */
+static int reserve_node_slots(void** array, int* capacity, int index, size_t elem_size) {
+    if (index < *capacity) {
+        return 0;
+    }
+    int new_capacity = *capacity > 0 ? *capacity : 64;
+    while (new_capacity <= index) {
+        new_capacity *= 2;
+    }
+    void* grown = realloc(*array, (size_t)new_capacity * elem_size);
+    if (!grown) {
+        return -1;
+    }
+    memset((char*)grown + (size_t)*capacity * elem_size, 0,
+           (size_t)(new_capacity - *capacity) * elem_size);
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+/**
+ * @brief Duplicate hold timer: forget an originator's window once it is idle
+ */
+static void duplicate_timer_expired(uint32_t originator) {
+    int index = lookup_node_index(originator);
+    if (index < 0 || index >= duplicate_capacity || duplicate_windows[index].timestamp == 0) {
+        return;
+    }
+    if (olsr_clock_now() - duplicate_windows[index].timestamp < DUPLICATE_HOLD_TIME) {
+        timer_wheel_schedule(duplicate_timer_expired, originator,
+                             duplicate_windows[index].timestamp + DUPLICATE_HOLD_TIME);
+        return;
+    }
+    memset(&duplicate_windows[index], 0, sizeof(struct duplicate_entry));
+}
+
+/**
+ * @brief Get the live duplicate window of an originator
+ * @return Window, or NULL if none is held (never seen or expired)
+ */
+static struct duplicate_entry* find_duplicate_window(int index, olsr_time_t now) {
+    if (index < 0 || index >= duplicate_capacity || duplicate_windows[index].timestamp == 0) {
+        return NULL;
+    }
+    if (now - duplicate_windows[index].timestamp >= DUPLICATE_HOLD_TIME) {
+        // Expired, its timer just has not run yet
+        memset(&duplicate_windows[index], 0, sizeof(struct duplicate_entry));
+        return NULL;
+    }
+    return &duplicate_windows[index];
+}
 
 // Global routing function implementations - always enabled
 int is_duplicate_message(uint32_t originator, uint16_t seq_number) {
-    for (int i = 0; i < duplicate_count; i++) {
-        if (duplicate_table[i].originator == originator &&
-            duplicate_table[i].seq_number == seq_number) {
-            return 1;
-        }
+    struct duplicate_entry* entry = find_duplicate_window(lookup_node_index(originator), olsr_clock_now());
+    if (!entry) {
+        return 0;
     }
-    return 0;
+    
+    int16_t diff = (int16_t)(uint16_t)(seq_number - entry->top_seq);
+    if (diff > 0) {
+        return 0;  // Newer than anything seen
+    }
+    if (-diff >= DUPLICATE_WINDOW_SIZE) {
+        return 1;  // Too old to tell apart, treat as already seen
+    }
+    return (entry->window >> -diff) & 1;
 }
 
 int add_duplicate_entry(uint32_t originator, uint16_t seq_number) {
-    if (duplicate_count >= MAX_DUPLICATE_ENTRIES) {
+    int index = intern_node(originator);
+    if (index < 0 ||
+        reserve_node_slots((void**)&duplicate_windows, &duplicate_capacity, index,
+                           sizeof(struct duplicate_entry)) != 0) {
         return -1;
     }
-    duplicate_table[duplicate_count].originator = originator;
-    duplicate_table[duplicate_count].seq_number = seq_number;
-    duplicate_table[duplicate_count].timestamp = time(NULL);
-    duplicate_count++;
+    
+    olsr_time_t now = olsr_clock_now();
+    struct duplicate_entry* entry = find_duplicate_window(index, now);
+    if (!entry) {
+        entry = &duplicate_windows[index];
+        entry->top_seq = seq_number;
+        entry->window = 1;
+    } else {
+        int16_t diff = (int16_t)(uint16_t)(seq_number - entry->top_seq);
+        if (diff > 0) {
+            // Slide the window forward to the new highest sequence number
+            entry->window = (diff < DUPLICATE_WINDOW_SIZE) ? (entry->window << diff) | 1 : 1;
+            entry->top_seq = seq_number;
+        } else if (-diff < DUPLICATE_WINDOW_SIZE) {
+            entry->window |= (uint64_t)1 << -diff;
+        }
+    }
+    
+    entry->timestamp = now;
+    timer_wheel_schedule(duplicate_timer_expired, originator, now + DUPLICATE_HOLD_TIME);
     return 0;
 }
 
-int add_topology_link(uint32_t from_node, uint32_t to_node, uint16_t ansn, time_t validity_time) {
-    for (int i = 0; i < global_topology_count; i++) {
-        if (global_topology[i].from_node == from_node &&
-            global_topology[i].to_node == to_node) {
-            if (ansn >= global_topology[i].ansn) {
-                global_topology[i].ansn = ansn;
-                global_topology[i].validity_time = validity_time;
-                return 0;
-            }
-            return 0;
+/**
+ * @brief Compare ANSNs with 16-bit wraparound (RFC 3626 section 19)
+ * @return Non-zero if a is more recent than b
+ */
+static int ansn_newer(uint16_t a, uint16_t b) {
+    return (a > b && a - b <= 32768) || (b > a && b - a > 32768);
+}
+
+/**
+ * @brief Get the topology set of an originator, creating an empty one if needed
+ */
+static struct topology_set* get_topology_set(uint32_t originator) {
+    int index = intern_node(originator);
+    if (index < 0 ||
+        reserve_node_slots((void**)&topology_sets, &topology_set_capacity, index,
+                           sizeof(struct topology_set)) != 0) {
+        return NULL;
+    }
+    return &topology_sets[index];
+}
+
+static void topology_timer_expired(uint32_t originator);
+
+/**
+ * @brief Drop every link of a topology set, feeding removals to the SPT
+ * @return Number of links removed
+ */
+static int clear_topology_set(uint32_t originator, struct topology_set* set) {
+    int removed = set->count;
+    timer_wheel_cancel(topology_timer_expired, originator);
+    for (int i = 0; i < set->count; i++) {
+        routing_link_removed(originator, set->targets[i]);
+    }
+    topology_link_count -= set->count;
+    set->count = 0;
+    set->ansn = 0;
+    set->validity_time = 0;
+    return removed;
+}
+
+/**
+ * @brief Validity timer: drop an originator's set once it expires
+ */
+static void topology_timer_expired(uint32_t originator) {
+    int index = lookup_node_index(originator);
+    if (index < 0 || index >= topology_set_capacity) {
+        return;
+    }
+    struct topology_set* set = &topology_sets[index];
+    if (set->validity_time == 0) {
+        return;
+    }
+    if (set->validity_time > olsr_clock_now()) {
+        timer_wheel_schedule(topology_timer_expired, originator, set->validity_time);
+        return;
+    }
+    clear_topology_set(originator, set);
+}
+
+int update_topology_set(uint32_t originator, uint16_t ansn, const uint32_t* advertised,
+                        int count, olsr_time_t validity_time) {
+    struct topology_set* set = get_topology_set(originator);
+    if (!set) {
+        printf("Error: Failed to grow topology database\n");
+        return -1;
+    }
+    if (set->validity_time > olsr_clock_now() && ansn_newer(set->ansn, ansn)) {
+        return 0;  // Out-of-order advertisement, keep the newer set
+    }
+    
+    // Interning count new nodes can produce indices up to this bound
+    int max_index = get_interned_node_count() + count;
+    if (count > set->capacity) {
+        uint32_t* targets = (uint32_t*)realloc(set->targets, (size_t)count * sizeof(uint32_t));
+        if (!targets) {
+            printf("Error: Failed to grow topology set\n");
+            return -1;
         }
+        set->targets = targets;
+        set->capacity = count;
+    }
+    if (reserve_node_slots((void**)&topology_mark, &topology_mark_capacity, max_index,
+                           sizeof(uint32_t)) != 0) {
+        printf("Error: Failed to grow topology database\n");
+        return -1;
     }
     
-    if (global_topology_count < MAX_TOPOLOGY_LINKS) {
-        global_topology[global_topology_count].from_node = from_node;
-        global_topology[global_topology_count].to_node = to_node;
-        global_topology[global_topology_count].ansn = ansn;
-        global_topology[global_topology_count].validity_time = validity_time;
-        global_topology_count++;
+    // Mark the old set, then classify the new one against it: entries
+    // found marked are kept, the rest are additions, and anything left
+    // with the old mark afterwards was withdrawn
+    topology_stamp += 4;
+    uint32_t old_mark = topology_stamp;
+    uint32_t kept_mark = topology_stamp + 1;
+    uint32_t added_mark = topology_stamp + 2;
+    uint32_t done_mark = topology_stamp + 3;
+    for (int i = 0; i < set->count; i++) {
+        topology_mark[lookup_node_index(set->targets[i])] = old_mark;
+    }
+    for (int i = 0; i < count; i++) {
+        int index = intern_node(advertised[i]);
+        if (index < 0) {
+            printf("Error: Failed to update topology set\n");
+            return -1;
+        }
+        if (topology_mark[index] == old_mark) {
+            topology_mark[index] = kept_mark;
+        } else if (topology_mark[index] != kept_mark && topology_mark[index] != added_mark) {
+            topology_mark[index] = added_mark;
+        }
+    }
+    
+    // Compact survivors in place, then append the additions
+    int changes = 0;
+    int write_pos = 0;
+    for (int i = 0; i < set->count; i++) {
+        if (topology_mark[lookup_node_index(set->targets[i])] == kept_mark) {
+            set->targets[write_pos++] = set->targets[i];
+        } else {
+            routing_link_removed(originator, set->targets[i]);
+            changes++;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        int index = lookup_node_index(advertised[i]);
+        if (topology_mark[index] == added_mark) {
+            topology_mark[index] = done_mark;
+            set->targets[write_pos++] = advertised[i];
+            routing_link_added(originator, advertised[i]);
+            changes++;
+        }
+    }
+    
+    topology_link_count += write_pos - set->count;
+    set->count = write_pos;
+    set->ansn = ansn;
+    set->validity_time = validity_time;
+    timer_wheel_schedule(topology_timer_expired, originator, validity_time);
+    return changes;
+}
+
+int apply_topology_delta(uint32_t originator, uint16_t base_ansn, uint16_t ansn,
+                         const uint32_t* added, int added_count,
+                         const uint32_t* removed, int removed_count,
+                         olsr_time_t validity_time) {
+    int index = lookup_node_index(originator);
+    struct topology_set* set = (index >= 0 && index < topology_set_capacity) ?
+                               &topology_sets[index] : NULL;
+    if (!set || set->validity_time <= olsr_clock_now()) {
+        return -1;  // Nothing to apply the changes to
+    }
+    if (set->ansn == ansn || ansn_newer(set->ansn, ansn)) {
+        return 0;  // Already applied, or superseded
+    }
+    if (set->ansn != base_ansn) {
+        return -1;  // Missed an ANSN in between
+    }
+    
+    int max_index = get_interned_node_count() + added_count;
+    if (set->count + added_count > set->capacity) {
+        uint32_t* targets = (uint32_t*)realloc(set->targets,
+            (size_t)(set->count + added_count) * sizeof(uint32_t));
+        if (!targets) {
+            printf("Error: Failed to grow topology set\n");
+            return -1;
+        }
+        set->targets = targets;
+        set->capacity = set->count + added_count;
+    }
+    if (reserve_node_slots((void**)&topology_mark, &topology_mark_capacity, max_index,
+                           sizeof(uint32_t)) != 0) {
+        printf("Error: Failed to grow topology database\n");
+        return -1;
+    }
+    
+    // Mark the current set, re-mark withdrawn entries, then compact
+    topology_stamp += 4;
+    uint32_t present_mark = topology_stamp;
+    uint32_t removed_mark = topology_stamp + 1;
+    for (int i = 0; i < set->count; i++) {
+        topology_mark[lookup_node_index(set->targets[i])] = present_mark;
+    }
+    for (int i = 0; i < removed_count; i++) {
+        int target = lookup_node_index(removed[i]);
+        if (target >= 0 && target < topology_mark_capacity && topology_mark[target] == present_mark) {
+            topology_mark[target] = removed_mark;
+        }
+    }
+    
+    int changes = 0;
+    int write_pos = 0;
+    for (int i = 0; i < set->count; i++) {
+        if (topology_mark[lookup_node_index(set->targets[i])] == removed_mark) {
+            routing_link_removed(originator, set->targets[i]);
+            changes++;
+        } else {
+            set->targets[write_pos++] = set->targets[i];
+        }
+    }
+    for (int i = 0; i < added_count; i++) {
+        int target = intern_node(added[i]);
+        if (target < 0) {
+            printf("Error: Failed to update topology set\n");
+            break;
+        }
+        if (topology_mark[target] != present_mark) {
+            topology_mark[target] = present_mark;
+            set->targets[write_pos++] = added[i];
+            routing_link_added(originator, added[i]);
+            changes++;
+        }
+    }
+    
+    topology_link_count += write_pos - set->count;
+    set->count = write_pos;
+    set->ansn = ansn;
+    set->validity_time = validity_time;
+    timer_wheel_schedule(topology_timer_expired, originator, validity_time);
+    return changes;
+}
+
+int add_topology_link(uint32_t from_node, uint32_t to_node, uint16_t ansn, olsr_time_t validity_time) {
+    struct topology_set* set = get_topology_set(from_node);
+    int to_index = intern_node(to_node);
+    if (!set || to_index < 0) {
+        return -1;
+    }
+    if (set->validity_time > olsr_clock_now() && ansn_newer(set->ansn, ansn)) {
         return 0;
     }
-    return -1;
+    
+    set->ansn = ansn;
+    set->validity_time = validity_time;
+    timer_wheel_schedule(topology_timer_expired, from_node, validity_time);
+    for (int i = 0; i < set->count; i++) {
+        if (set->targets[i] == to_node) {
+            return 0;
+        }
+    }
+    
+    if (set->count >= set->capacity) {
+        int capacity = set->capacity > 0 ? 2 * set->capacity : 4;
+        uint32_t* targets = (uint32_t*)realloc(set->targets, (size_t)capacity * sizeof(uint32_t));
+        if (!targets) {
+            return -1;
+        }
+        set->targets = targets;
+        set->capacity = capacity;
+    }
+    set->targets[set->count++] = to_node;
+    topology_link_count++;
+    routing_link_added(from_node, to_node);
+    return 0;
 }
 
 int get_all_topology_links(struct topology_link* links, int max_links) {
     int count = 0;
-    time_t now = time(NULL);
+    olsr_time_t now = olsr_clock_now();
     
-    for (int i = 0; i < global_topology_count && count < max_links; i++) {
-        if (global_topology[i].validity_time > now) {
-            links[count].from_id = global_topology[i].from_node;
-            links[count].to_id = global_topology[i].to_node;
+    for (int i = 0; i < topology_set_capacity && count < max_links; i++) {
+        struct topology_set* set = &topology_sets[i];
+        if (set->validity_time <= now) {
+            continue;
+        }
+        uint32_t originator = node_id_of(i);
+        for (int j = 0; j < set->count && count < max_links; j++) {
+            links[count].from_id = originator;
+            links[count].to_id = set->targets[j];
             links[count].cost = 1;
-            links[count].validity = global_topology[i].validity_time;
+            links[count].validity = set->validity_time;
             count++;
         }
     }
     return count;
 }
 
+/**
+ * @brief Check whether a node appears in any valid topology set
+ */
+static int topology_has_node(uint32_t id) {
+    olsr_time_t now = olsr_clock_now();
+    int index = lookup_node_index(id);
+    
+    if (index >= 0 && index < topology_set_capacity &&
+        topology_sets[index].validity_time > now && topology_sets[index].count > 0) {
+        return 1;  // Advertises links itself
+    }
+    for (int i = 0; i < topology_set_capacity; i++) {
+        struct topology_set* set = &topology_sets[i];
+        if (set->validity_time <= now) {
+            continue;
+        }
+        for (int j = 0; j < set->count; j++) {
+            if (set->targets[j] == id) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Drop every expired topology set now
+ * 
+ * Sets normally expire through their validity timers; this sweep is kept
+ * for callers that do not run the timer wheel and before full rebuilds.
+ * 
+ * @return Number of links removed
+ */
 int cleanup_topology_links(void) {
-    time_t now = time(NULL);
+    olsr_time_t now = olsr_clock_now();
     int cleaned = 0;
-    int new_count = 0;
     
-    for (int i = 0; i < global_topology_count; i++) {
-        if (global_topology[i].validity_time > now) {
-            if (new_count != i) {
-                global_topology[new_count] = global_topology[i];
-            }
-            new_count++;
-        } else {
+    for (int i = 0; i < topology_set_capacity; i++) {
+        struct topology_set* set = &topology_sets[i];
+        if (set->validity_time != 0 && set->validity_time <= now) {
+            cleaned += clear_topology_set(node_id_of(i), set);
+        }
+    }
+    return cleaned;
+}
+
+/**
+ * @brief Drop every expired duplicate window now
+ * 
+ * Windows normally expire through their hold timers; this sweep is kept
+ * for callers that do not run the timer wheel.
+ * 
+ * @return Number of windows dropped
+ */
+int cleanup_duplicate_table(void) {
+    olsr_time_t now = olsr_clock_now();
+    int cleaned = 0;
+    
+    for (int i = 0; i < duplicate_capacity; i++) {
+        if (duplicate_windows[i].timestamp != 0 &&
+            now - duplicate_windows[i].timestamp >= DUPLICATE_HOLD_TIME) {
+            timer_wheel_cancel(duplicate_timer_expired, node_id_of(i));
+            memset(&duplicate_windows[i], 0, sizeof(struct duplicate_entry));
             cleaned++;
         }
     }
-    global_topology_count = new_count;
-    return cleaned;
+    return cleaned;
+}
+
+int should_forward_message(uint32_t sender_addr, uint32_t originator_addr) {
+    (void)originator_addr;
+    struct neighbor_entry* sender = find_neighbor(sender_addr);
+    return (sender && sender->link_status == SYM_LINK && sender->is_mpr_selector) ? 1 : 0;
+}
+
+int forward_tc_message(struct olsr_message* msg, uint32_t sender_addr, struct control_queue* queue) {
+    (void)sender_addr;
+    if (!msg || !queue || msg->ttl <= 1) {
+        return -1;
+    }
+    
+    struct olsr_tc* tc = (struct olsr_tc*)msg->body;
+    
+    // Create a decremented TTL copy of the message for forwarding
+    msg->ttl--;
+    msg->hop_count++;
+    
+    // Counted toward the slot allocation load through the queue's push counter
+    return push_control_message(queue, MSG_TC, (void*)tc, CONTROL_CLASS_FORWARD);
+}
+
+// External variables from other modules
+extern uint32_t node_id;
+extern struct neighbor_entry* neighbor_table;
+extern int neighbor_count;
+
+/**
+ * @brief Convert a node ID to a string representation
+ * @param id The node ID to convert
+ * @param buffer Buffer to store the string representation (must be at least 16 bytes)
+ * @return Pointer to the buffer
+ */
+static char* id_to_string(uint32_t id, char* buffer) {
+    unsigned char* bytes = (unsigned char*)&id;
+    snprintf(buffer, 16, "%d.%d.%d.%d", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return buffer;
+}
+
+/** @brief Global routing table (grown on demand, starts at MAX_ROUTING_ENTRIES) */
+static struct routing_table_entry* routing_table = NULL;
+/** @brief Current number of routing entries */
+static int routing_table_size = 0;
+/** @brief Allocated entries in routing_table */
+static int routing_table_capacity = 0;
+
+/** @brief Position in routing_table per interned node index (validated on use) */
+static int* route_position = NULL;
+/** @brief Allocated entries in route_position */
+static int route_position_capacity = 0;
+
+/**
+ * @brief Find the routing table slot for a destination in O(1)
+ * @return Index into routing_table, or -1 if there is no route
+ */
+static int find_route_index(uint32_t dest_id) {
+    int index = lookup_node_index(dest_id);
+    if (index < 0 || index >= route_position_capacity) {
+        return -1;
+    }
+    int pos = route_position[index];
+    if (pos < 0 || pos >= routing_table_size || routing_table[pos].dest_id != dest_id) {
+        return -1;
+    }
+    return pos;
+}
+
+/**
+ * @brief Record the routing table slot of an added or moved entry
+ * @return 0 on success, -1 on allocation failure
+ */
+static int index_route_position(int pos) {
+    int index = intern_node(routing_table[pos].dest_id);
+    if (index < 0) {
+        return -1;
+    }
+    if (index >= route_position_capacity) {
+        int capacity = route_position_capacity > 0 ? route_position_capacity : 64;
+        while (capacity <= index) {
+            capacity *= 2;
+        }
+        int* grown = (int*)realloc(route_position, (size_t)capacity * sizeof(int));
+        if (!grown) {
+            return -1;
+        }
+        memset(grown + route_position_capacity, -1,
+               (size_t)(capacity - route_position_capacity) * sizeof(int));
+        route_position = grown;
+        route_position_capacity = capacity;
+    }
+    route_position[index] = pos;
+    return 0;
+}
+
+/**
+ * @brief Resolve the neighbor entry behind a route's next hop
+ * 
+ * The pointer is cached in the routing entry and reused for as long as
+ * the neighbor table has not moved or removed entries, so the forwarding
+ * path normally does no lookup at all.
+ * 
+ * @return Neighbor entry of the next hop, or NULL if it is not a neighbor
+ */
+static struct neighbor_entry* route_next_hop_neighbor(struct routing_table_entry* route) {
+    if (route->next_hop_entry && route->neighbor_generation == neighbor_table_generation) {
+        return route->next_hop_entry;
+    }
+    route->next_hop_entry = find_neighbor(route->next_hop_id);
+    route->neighbor_generation = neighbor_table_generation;
+    return route->next_hop_entry;
+}
+
+/**
+ * @brief Read-only copy of the routing table published to other threads
+ * 
+ * Routes are rebuilt in place in routing_table by the thread that runs
+ * the protocol. Other threads (e.g. the RRC interface) read a snapshot
+ * instead: the writer fills the spare buffer, then publishes it with a
+ * single atomic pointer swap. Each buffer counts its active readers, and
+ * the writer only reuses a buffer once no reader is left on it, so
+ * lookups never block and never observe a half-built table.
+ */
+struct routing_snapshot {
+    struct routing_table_entry* entries; /**< Copy of routing_table */
+    int size;                            /**< Number of valid entries */
+    int capacity;                        /**< Allocated entries */
+    int* slots;                          /**< Open-addressed dest_id -> entry index (-1 = empty) */
+    int slot_capacity;                   /**< Number of slots (power of two) */
+    int readers;                         /**< Readers currently using this buffer */
+};
+
+/** @brief Double buffer for routing snapshots */
+static struct routing_snapshot routing_snapshots[2];
+/** @brief Snapshot visible to readers (NULL until the first publish) */
+static struct routing_snapshot* current_snapshot = NULL;
+/** @brief Set when routing_table differs from the published snapshot */
+static int snapshot_dirty = 1;
+
+/**
+ * @brief Hash a destination to its home slot in a snapshot
+ */
+static unsigned int snapshot_slot(const struct routing_snapshot* snap, uint32_t dest_id) {
+    return (dest_id * 2654435761u) & (unsigned int)(snap->slot_capacity - 1);
+}
+
+/**
+ * @brief Copy routing_table into the spare buffer and make it current
+ * 
+ * Must only be called by the single thread that modifies routing_table.
+ */
+static void publish_routing_snapshot(void) {
+    if (!snapshot_dirty) {
+        return;
+    }
+    
+    struct routing_snapshot* current = __atomic_load_n(&current_snapshot, __ATOMIC_SEQ_CST);
+    struct routing_snapshot* spare = (current == &routing_snapshots[0]) ?
+                                     &routing_snapshots[1] : &routing_snapshots[0];
+    
+    // Grace period: wait for readers that picked up the spare before the last swap
+    while (__atomic_load_n(&spare->readers, __ATOMIC_SEQ_CST) != 0) {
+        sched_yield();
+    }
+    
+    if (routing_table_size > spare->capacity) {
+        int capacity = routing_table_capacity;
+        struct routing_table_entry* entries = (struct routing_table_entry*)realloc(
+            spare->entries, (size_t)capacity * sizeof(struct routing_table_entry));
+        if (!entries) {
+            printf("Error: Failed to grow routing snapshot\n");
+            return;
+        }
+        spare->entries = entries;
+        spare->capacity = capacity;
+    }
+    
+    int slot_capacity = spare->slot_capacity > 0 ? spare->slot_capacity : 16;
+    while (slot_capacity < 2 * routing_table_size) {
+        slot_capacity *= 2;
+    }
+    if (slot_capacity != spare->slot_capacity) {
+        int* slots = (int*)realloc(spare->slots, (size_t)slot_capacity * sizeof(int));
+        if (!slots) {
+            printf("Error: Failed to grow routing snapshot\n");
+            return;
+        }
+        spare->slots = slots;
+        spare->slot_capacity = slot_capacity;
+    }
+    
+    if (routing_table_size > 0) {
+        memcpy(spare->entries, routing_table,
+               (size_t)routing_table_size * sizeof(struct routing_table_entry));
+    }
+    spare->size = routing_table_size;
+    memset(spare->slots, -1, (size_t)spare->slot_capacity * sizeof(int));
+    for (int i = 0; i < spare->size; i++) {
+        unsigned int slot = snapshot_slot(spare, spare->entries[i].dest_id);
+        while (spare->slots[slot] != -1) {
+            slot = (slot + 1) & (unsigned int)(spare->slot_capacity - 1);
+        }
+        spare->slots[slot] = i;
+    }
+    
+    __atomic_store_n(&current_snapshot, spare, __ATOMIC_SEQ_CST);
+    snapshot_dirty = 0;
+}
+
+/**
+ * @brief Add or update a topology link from TC message (legacy compatibility)
+ * @param from_id Source node ID
+ * @param to_id Destination node ID  
+ * @param validity Validity time
+ * @return 0 on success, -1 on allocation failure
+ * 
+ * NOTE: Kept for backward compatibility. The link is merged into the
+ * originator's set in the global topology database under its current
+ * ANSN; new code should use update_topology_set() directly.
+ */
+int update_tc_topology(uint32_t from_id, uint32_t to_id, olsr_time_t validity) {
+    int index = lookup_node_index(from_id);
+    uint16_t ansn = (index >= 0 && index < topology_set_capacity) ? topology_sets[index].ansn : 0;
+    return add_topology_link(from_id, to_id, ansn, validity);
+}
+
+/**
+ * @brief Remove expired TC topology links
+ */
+void cleanup_tc_topology(void) {
+    cleanup_topology_links();
+}
+
+/**
+ * @brief Heap entry for Dijkstra's priority queue
+ *
+ * Entries are pushed on every successful relaxation and stale ones are
+ * skipped when popped (lazy deletion), so the heap never needs decrease-key.
+ */
+struct spt_heap_item {
+    int dist;    /**< Tentative distance when the entry was pushed */
+    int vertex;  /**< Dense vertex index */
+};
+
+/**
+ * @brief Mutable adjacency list of one vertex
+ *
+ * Parallel links (e.g. the same arc learned from two sources) are stored
+ * as duplicate entries, so removing one copy leaves the arc in place.
+ */
+struct spt_adj {
+    int* arcs;     /**< Adjacent vertex indices */
+    int count;     /**< Number of arcs in use */
+    int capacity;  /**< Allocated arc slots */
+};
+
+/**
+ * @brief Vertex touched by an incremental update, with its previous route
+ */
+struct spt_change {
+    int vertex;         /**< Dense vertex index */
+    int old_dist;       /**< Distance before the update */
+    int old_first_hop;  /**< First hop vertex before the update */
+};
+
+/**
+ * @brief Shortest path tree state
+ *
+ * Vertices are the dense indices handed out by the shared node index, so
+ * per-vertex arrays cover every interned node; nodes that are not part of
+ * the current graph simply have no arcs and stay unreachable.
+ *
+ * A full calculation builds a CSR adjacency from the topology_link array and
+ * runs Dijkstra over it, then seeds mutable in/out adjacency lists and the
+ * parent pointers of the resulting tree. Single link additions and removals
+ * are then repaired in place by routing_link_added()/routing_link_removed().
+ * Buffers only grow, so steady-state updates do not allocate.
+ */
+static struct {
+    int valid;            /**< 1 when the tree matches the published routing table */
+    uint32_t source;      /**< Root of the tree */
+    int src_index;        /**< Vertex index of the root */
+    int node_capacity;    /**< Capacity of the per-vertex arrays */
+    int node_count;       /**< Vertices with initialised state */
+    int* offsets;         /**< CSR row offsets (node_count + 1 entries) */
+    int* targets;         /**< CSR adjacency: destination vertex of each arc */
+    int* costs;           /**< CSR adjacency: cost of each arc */
+    int* edge_src;        /**< Source vertex of each input link (CSR build scratch) */
+    int link_capacity;    /**< Capacity of the per-link arrays */
+    int* dist;            /**< Distance from source per vertex */
+    int* hops;            /**< Hop count from source per vertex */
+    int* first_hop;       /**< First vertex on the path from source per vertex (-1 = none) */
+    int* parent;          /**< Predecessor in the tree per vertex (-1 = none) */
+    struct spt_adj* out;  /**< Outgoing arcs per vertex */
+    struct spt_adj* in;   /**< Incoming arcs per vertex */
+    int arc_count;        /**< Total arcs in the mutable adjacency */
+    unsigned char* touched;      /**< Per-vertex flag: recorded in changes[] */
+    struct spt_change* changes;  /**< Vertices touched by the current update */
+    int change_count;     /**< Entries in changes[] */
+    struct spt_heap_item* heap;  /**< Binary min-heap storage */
+    int heap_capacity;    /**< Allocated heap entries */
+} spt;
+
+/** @brief Set when a topology change could not be applied incrementally */
+static int routing_dirty = 0;
+
+static int remove_routing_entry(uint32_t dest_id);
+
+/**
+ * @brief Grow a scratch array to hold at least count elements
+ * @return 0 on success, -1 on allocation failure
+ */
+static int reserve_array(void** array, size_t count, size_t elem_size) {
+    void* grown = realloc(*array, count * elem_size);
+    if (!grown) {
+        return -1;
+    }
+    *array = grown;
+    return 0;
+}
+
+/**
+ * @brief Ensure per-vertex arrays can hold max_nodes
+ * @return 0 on success, -1 on allocation failure
+ */
+static int spt_reserve_nodes(int max_nodes) {
+    if (max_nodes > spt.node_capacity) {
+        size_t n = (size_t)max_nodes;
+        if (reserve_array((void**)&spt.offsets, n + 1, sizeof(int)) != 0 ||
+            reserve_array((void**)&spt.dist, n, sizeof(int)) != 0 ||
+            reserve_array((void**)&spt.hops, n, sizeof(int)) != 0 ||
+            reserve_array((void**)&spt.first_hop, n, sizeof(int)) != 0 ||
+            reserve_array((void**)&spt.parent, n, sizeof(int)) != 0 ||
+            reserve_array((void**)&spt.out, n, sizeof(struct spt_adj)) != 0 ||
+            reserve_array((void**)&spt.in, n, sizeof(struct spt_adj)) != 0 ||
+            reserve_array((void**)&spt.touched, n, sizeof(unsigned char)) != 0 ||
+            reserve_array((void**)&spt.changes, n, sizeof(struct spt_change)) != 0) {
+            return -1;
+        }
+        size_t added = n - (size_t)spt.node_capacity;
+        memset(spt.out + spt.node_capacity, 0, added * sizeof(struct spt_adj));
+        memset(spt.in + spt.node_capacity, 0, added * sizeof(struct spt_adj));
+        memset(spt.touched + spt.node_capacity, 0, added);
+        spt.node_capacity = max_nodes;
+    }
+    return 0;
+}
+
+/**
+ * @brief Ensure CSR build arrays can hold link_count links
+ * @return 0 on success, -1 on allocation failure
+ */
+static int spt_reserve_links(int link_count) {
+    if (link_count > spt.link_capacity) {
+        size_t m = (size_t)link_count;
+        if (reserve_array((void**)&spt.targets, m, sizeof(int)) != 0 ||
+            reserve_array((void**)&spt.costs, m, sizeof(int)) != 0 ||
+            reserve_array((void**)&spt.edge_src, m, sizeof(int)) != 0) {
+            return -1;
+        }
+        spt.link_capacity = link_count;
+    }
+    return 0;
+}
+
+/**
+ * @brief Ensure the heap can hold the given number of pending entries
+ * @return 0 on success, -1 on allocation failure
+ */
+static int spt_reserve_heap(int entries) {
+    if (entries > spt.heap_capacity) {
+        if (reserve_array((void**)&spt.heap, (size_t)entries, sizeof(struct spt_heap_item)) != 0) {
+            return -1;
+        }
+        spt.heap_capacity = entries;
+    }
+    return 0;
+}
+
+/**
+ * @brief Initialise tree state for vertices interned since the last call
+ * @return 0 on success, -1 on allocation failure
+ */
+static int spt_sync_nodes(void) {
+    int interned = get_interned_node_count();
+    if (interned <= spt.node_count) {
+        return 0;
+    }
+    if (interned > spt.node_capacity) {
+        int capacity = spt.node_capacity > 0 ? spt.node_capacity : 16;
+        while (capacity < interned) {
+            capacity *= 2;
+        }
+        if (spt_reserve_nodes(capacity) != 0) {
+            return -1;
+        }
+    }
+
+    for (int v = spt.node_count; v < interned; v++) {
+        spt.dist[v] = INFINITE_COST;
+        spt.hops[v] = 0;
+        spt.first_hop[v] = -1;
+        spt.parent[v] = -1;
+        spt.out[v].count = 0;
+        spt.in[v].count = 0;
+    }
+    spt.node_count = interned;
+    return 0;
+}
+
+/**
+ * @brief Find the vertex index of a node ID
+ * @return Vertex index, or -1 if the node has no tree state
+ */
+static int spt_lookup(uint32_t id) {
+    int v = lookup_node_index(id);
+    return (v < spt.node_count) ? v : -1;
+}
+
+/**
+ * @brief Map a node ID to its vertex index, interning it if new
+ *
+ * New vertices start unreachable with empty adjacency.
+ *
+ * @return Vertex index, or -1 on allocation failure
+ */
+static int spt_vertex(uint32_t id) {
+    int v = intern_node(id);
+    if (v == -1 || spt_sync_nodes() != 0) {
+        return -1;
+    }
+    return v;
+}
+
+/**
+ * @brief Drop all arcs and reset every vertex to unreachable except the source
+ * @return Source vertex index, or -1 on allocation failure
+ */
+static int spt_reset(uint32_t source) {
+    spt.arc_count = 0;
+    spt.source = source;
+    spt.src_index = spt_vertex(source);
+    if (spt.src_index == -1) {
+        return -1;
+    }
+
+    for (int v = 0; v < spt.node_count; v++) {
+        spt.dist[v] = INFINITE_COST;
+        spt.hops[v] = 0;
+        spt.first_hop[v] = -1;
+        spt.parent[v] = -1;
+        spt.out[v].count = 0;
+        spt.in[v].count = 0;
+    }
+    spt.dist[spt.src_index] = 0;
+    return spt.src_index;
+}
+
+/**
+ * @brief Append an arc to an adjacency list
+ * @return 0 on success, -1 on allocation failure
+ */
+static int spt_adj_push(struct spt_adj* adj, int vertex) {
+    if (adj->count == adj->capacity) {
+        int capacity = adj->capacity > 0 ? 2 * adj->capacity : 4;
+        if (reserve_array((void**)&adj->arcs, (size_t)capacity, sizeof(int)) != 0) {
+            return -1;
+        }
+        adj->capacity = capacity;
+    }
+    adj->arcs[adj->count++] = vertex;
+    return 0;
 }
 
-int cleanup_duplicate_table(void) {
-    time_t now = time(NULL);
-    int cleaned = 0;
-    int new_count = 0;
-    
-    for (int i = 0; i < duplicate_count; i++) {
-        if (now - duplicate_table[i].timestamp < DUPLICATE_HOLD_TIME) {
-            if (new_count != i) {
-                duplicate_table[new_count] = duplicate_table[i];
-            }
-            new_count++;
-        } else {
-            cleaned++;
+/**
+ * @brief Remove one copy of an arc from an adjacency list
+ * @return 1 if an arc was removed, 0 if not present
+ */
+static int spt_adj_remove(struct spt_adj* adj, int vertex) {
+    for (int i = 0; i < adj->count; i++) {
+        if (adj->arcs[i] == vertex) {
+            adj->arcs[i] = adj->arcs[--adj->count];
+            return 1;
         }
     }
-    duplicate_count = new_count;
-    return cleaned;
+    return 0;
 }
 
-int should_forward_message(uint32_t sender_addr, uint32_t originator_addr) {
-    (void)originator_addr;
-    for (int i = 0; i < neighbor_count; i++) {
-        if (neighbor_table[i].neighbor_id == sender_addr &&
-            neighbor_table[i].link_status == SYM_LINK &&
-            neighbor_table[i].is_mpr_selector) {
+/**
+ * @brief Check whether an adjacency list contains an arc
+ */
+static int spt_adj_contains(const struct spt_adj* adj, int vertex) {
+    for (int i = 0; i < adj->count; i++) {
+        if (adj->arcs[i] == vertex) {
             return 1;
         }
     }
     return 0;
 }
 
-int forward_tc_message(struct olsr_message* msg, uint32_t sender_addr, struct control_queue* queue) {
-    (void)sender_addr;
-    if (!msg || !queue || msg->ttl <= 1) {
-        return -1;
+/**
+ * @brief Push an entry onto the min-heap
+ */
+static void spt_heap_push(int* size, int dist, int vertex) {
+    struct spt_heap_item* heap = spt.heap;
+    int i = (*size)++;
+
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (heap[parent].dist <= dist) {
+            break;
+        }
+        heap[i] = heap[parent];
+        i = parent;
     }
-    
-    struct olsr_tc* tc = (struct olsr_tc*)msg->body;
-    
-    // Create a decremented TTL copy of the message for forwarding
-    msg->ttl--;
-    msg->hop_count++;
-    
-    return push_to_control_queue(queue, MSG_TC, (void*)tc);
+    heap[i].dist = dist;
+    heap[i].vertex = vertex;
 }
 
-// External variables from other modules
-extern uint32_t node_id;
-extern struct neighbor_entry neighbor_table[];
-extern int neighbor_count;
-
 /**
- * @brief Convert a node ID to a string representation
- * @param id The node ID to convert
- * @param buffer Buffer to store the string representation (must be at least 16 bytes)
- * @return Pointer to the buffer
+ * @brief Pop the minimum entry from the min-heap
  */
-static char* id_to_string(uint32_t id, char* buffer) {
-    unsigned char* bytes = (unsigned char*)&id;
-    snprintf(buffer, 16, "%d.%d.%d.%d", bytes[0], bytes[1], bytes[2], bytes[3]);
-    return buffer;
+static struct spt_heap_item spt_heap_pop(int* size) {
+    struct spt_heap_item* heap = spt.heap;
+    struct spt_heap_item top = heap[0];
+    struct spt_heap_item last = heap[--(*size)];
+    int i = 0;
+
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= *size) {
+            break;
+        }
+        if (child + 1 < *size && heap[child + 1].dist < heap[child].dist) {
+            child++;
+        }
+        if (last.dist <= heap[child].dist) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (*size > 0) {
+        heap[i] = last;
+    }
+    return top;
 }
 
-/** @brief Global routing table */
-static struct routing_table_entry routing_table[MAX_ROUTING_ENTRIES];
-/** @brief Current number of routing entries */
-static int routing_table_size = 0;
+/**
+ * @brief Remember a vertex's current route before an incremental update changes it
+ */
+static void spt_record(int v) {
+    if (spt.touched[v]) {
+        return;
+    }
+    spt.touched[v] = 1;
+    spt.changes[spt.change_count].vertex = v;
+    spt.changes[spt.change_count].old_dist = spt.dist[v];
+    spt.changes[spt.change_count].old_first_hop = spt.first_hop[v];
+    spt.change_count++;
+}
 
-/** @brief Topology information from TC messages */
-static struct topology_link tc_topology[MAX_NODES * MAX_NODES];
-/** @brief Number of links in TC topology */
-static int tc_topology_size = 0;
+/**
+ * @brief Make u the tree parent of v over a unit-cost arc
+ */
+static void spt_attach(int v, int u) {
+    spt.dist[v] = spt.dist[u] + 1;
+    spt.hops[v] = spt.hops[u] + 1;
+    spt.parent[v] = u;
+    spt.first_hop[v] = (u == spt.src_index) ? v : spt.first_hop[u];
+}
 
 /**
- * @brief Add or update a topology link from TC message (legacy compatibility)
- * @param from_id Source node ID
- * @param to_id Destination node ID  
- * @param validity Validity time
- * @return 0 on success, -1 if topology table is full
- * 
- * NOTE: This function maintains the legacy tc_topology array for backward
- * compatibility. New code should use the global topology database directly.
+ * @brief Settle pending heap entries over the mutable adjacency
+ *
+ * Only vertices whose distance improves are touched, so the work is
+ * proportional to the part of the tree that actually changes.
  */
-int update_tc_topology(uint32_t from_id, uint32_t to_id, time_t validity) {
-    if (tc_topology_size >= MAX_NODES * MAX_NODES) {
-        return -1;  // Topology table full
+static void spt_propagate(int heap_size) {
+    while (heap_size > 0) {
+        struct spt_heap_item item = spt_heap_pop(&heap_size);
+        int u = item.vertex;
+        if (item.dist != spt.dist[u]) {
+            continue;
+        }
+
+        struct spt_adj* out = &spt.out[u];
+        for (int i = 0; i < out->count; i++) {
+            int v = out->arcs[i];
+            if (spt.dist[u] + 1 < spt.dist[v]) {
+                spt_record(v);
+                spt_attach(v, u);
+                spt_heap_push(&heap_size, spt.dist[v], v);
+            }
+        }
     }
-    
-    tc_topology[tc_topology_size].from_id = from_id;
-    tc_topology[tc_topology_size].to_id = to_id;
-    tc_topology[tc_topology_size].cost = 1;  // Standard OLSR cost
-    tc_topology[tc_topology_size].validity = validity;
-    tc_topology_size++;
-    
-    char from_str[16], to_str[16];
-    printf("Legacy TC topology: %s -> %s (validity=%lds)\n",
-           id_to_string(from_id, from_str),
-           id_to_string(to_id, to_str),
-           (long)(validity - time(NULL)));
-    
-    return 0;
 }
 
 /**
- * @brief Remove expired TC topology links
+ * @brief Publish routing entries for vertices whose route actually changed
+ * @return Number of routing entries added, updated or removed
  */
-void cleanup_tc_topology(void) {
-    time_t now = time(NULL);
-    int i = 0;
-    
-    while (i < tc_topology_size) {
-        if (tc_topology[i].validity <= now) {
-            // Remove expired link by shifting remaining entries
-            char from_str[16], to_str[16];
-            printf("Removing expired TC link: %s -> %s\n",
-                   id_to_string(tc_topology[i].from_id, from_str),
-                   id_to_string(tc_topology[i].to_id, to_str));
-            
-            for (int j = i; j < tc_topology_size - 1; j++) {
-                tc_topology[j] = tc_topology[j + 1];
-            }
-            tc_topology_size--;
+static int spt_publish_changes(void) {
+    int published = 0;
+
+    for (int i = 0; i < spt.change_count; i++) {
+        struct spt_change* change = &spt.changes[i];
+        int v = change->vertex;
+        spt.touched[v] = 0;
+
+        if (spt.dist[v] == change->old_dist && spt.first_hop[v] == change->old_first_hop) {
+            continue;
+        }
+        if (spt.dist[v] == INFINITE_COST) {
+            remove_routing_entry(node_id_of(v));
         } else {
-            i++;
+            add_routing_entry(node_id_of(v), node_id_of(spt.first_hop[v]), spt.dist[v], spt.hops[v]);
         }
+        published++;
     }
+    spt.change_count = 0;
+    publish_routing_snapshot();
+    return published;
 }
 
 /**
- * @brief Find minimum distance vertex not yet processed
+ * @brief Check that the tree can accept an incremental update
  */
-static int find_min_distance(int* dist, int* sptSet, int node_count) {
-    int min = INFINITE_COST;
-    int min_index = -1;
-    
-    for (int v = 0; v < node_count; v++) {
-        if (sptSet[v] == 0 && dist[v] <= min) {
-            min = dist[v];
-            min_index = v;
-        }
+static int spt_ready(void) {
+    if (!spt.valid || spt.source != node_id) {
+        routing_dirty = 1;
+        return 0;
     }
-    return min_index;
+    return 1;
 }
 
 /**
- * @brief Find index of node in node array
+ * @brief Invalidate the tree after an allocation failure
  */
-static int find_node_index(uint32_t* nodes, int node_count, uint32_t target_id) {
-    for (int i = 0; i < node_count; i++) {
-        if (nodes[i] == target_id) {
-            return i;
+static int spt_fail(void) {
+    printf("Error: Out of memory for shortest path update - full recalculation required\n");
+    spt.valid = 0;
+    routing_dirty = 1;
+    return -1;
+}
+
+/**
+ * @brief Apply a single unit-cost link addition to the shortest path tree
+ *
+ * If the new arc shortens the path to its head, the improvement is pushed
+ * down the affected subtree with a dynamic Dijkstra; otherwise only the
+ * adjacency is updated.
+ *
+ * @return Number of routing entries changed, or -1 if a full recalculation is required
+ */
+int routing_link_added(uint32_t from_id, uint32_t to_id) {
+    if (!spt_ready()) {
+        return -1;
+    }
+    if (from_id == to_id) {
+        return 0;
+    }
+
+    int u = spt_vertex(from_id);
+    int v = spt_vertex(to_id);
+    if (u == -1 || v == -1 ||
+        spt_adj_push(&spt.out[u], v) != 0) {
+        return spt_fail();
+    }
+    if (spt_adj_push(&spt.in[v], u) != 0) {
+        spt_adj_remove(&spt.out[u], v);
+        return spt_fail();
+    }
+    spt.arc_count++;
+
+    if (spt.dist[u] == INFINITE_COST || spt.dist[u] + 1 >= spt.dist[v]) {
+        return 0;  // Tree unaffected
+    }
+    if (spt_reserve_heap(spt.arc_count + spt.node_count + 1) != 0) {
+        return spt_fail();
+    }
+
+    int heap_size = 0;
+    spt_record(v);
+    spt_attach(v, u);
+    spt_heap_push(&heap_size, spt.dist[v], v);
+    spt_propagate(heap_size);
+
+    int changed = spt_publish_changes();
+    if (changed > 0) {
+        printf("Incremental SPT: link added, %d routes changed\n", changed);
+    }
+    return changed;
+}
+
+/**
+ * @brief Apply a single unit-cost link removal to the shortest path tree
+ *
+ * If the arc was a tree edge, the subtree below it is detached, each of its
+ * vertices is re-seeded from its best surviving in-arc outside the subtree,
+ * and Dijkstra settles the subtree again. The rest of the tree is untouched.
+ *
+ * @return Number of routing entries changed, or -1 if a full recalculation is required
+ */
+int routing_link_removed(uint32_t from_id, uint32_t to_id) {
+    if (!spt_ready()) {
+        return -1;
+    }
+
+    int u = spt_lookup(from_id);
+    int v = spt_lookup(to_id);
+    if (u == -1 || v == -1 || !spt_adj_remove(&spt.out[u], v)) {
+        return 0;  // Arc not in the graph
+    }
+    spt_adj_remove(&spt.in[v], u);
+    spt.arc_count--;
+
+    if (spt.parent[v] != u || spt_adj_contains(&spt.out[u], v)) {
+        return 0;  // Not a tree edge, or a parallel arc still carries it
+    }
+    if (spt_reserve_heap(spt.arc_count + spt.node_count + 1) != 0) {
+        return spt_fail();
+    }
+
+    // Collect the subtree hanging below the removed arc
+    spt_record(v);
+    for (int i = 0; i < spt.change_count; i++) {
+        int x = spt.changes[i].vertex;
+        struct spt_adj* out = &spt.out[x];
+        for (int j = 0; j < out->count; j++) {
+            int y = out->arcs[j];
+            if (spt.parent[y] == x) {
+                spt_record(y);
+            }
         }
     }
-    return -1;
+    for (int i = 0; i < spt.change_count; i++) {
+        int x = spt.changes[i].vertex;
+        spt.dist[x] = INFINITE_COST;
+        spt.hops[x] = 0;
+        spt.first_hop[x] = -1;
+        spt.parent[x] = -1;
+    }
+
+    // Re-seed each detached vertex from its best reachable in-neighbour
+    int heap_size = 0;
+    for (int i = 0; i < spt.change_count; i++) {
+        int x = spt.changes[i].vertex;
+        struct spt_adj* in = &spt.in[x];
+        for (int j = 0; j < in->count; j++) {
+            int w = in->arcs[j];
+            if (spt.dist[w] != INFINITE_COST && spt.dist[w] + 1 < spt.dist[x]) {
+                spt_attach(x, w);
+            }
+        }
+        if (spt.dist[x] != INFINITE_COST) {
+            spt_heap_push(&heap_size, spt.dist[x], x);
+        }
+    }
+    spt_propagate(heap_size);
+
+    int changed = spt_publish_changes();
+    if (changed > 0) {
+        printf("Incremental SPT: link removed, %d routes changed\n", changed);
+    }
+    return changed;
 }
 
 /**
@@ -276,7 +1270,6 @@ static int find_node_index(uint32_t* nodes, int node_count, uint32_t target_id)
  */
 int build_topology_graph(struct topology_link* topology, int max_links) {
     int link_count = 0;
-    time_t now = time(NULL);
     
     printf("\n=== BUILDING COMPLETE TOPOLOGY GRAPH ===\n");
     
@@ -287,7 +1280,7 @@ int build_topology_graph(struct topology_link* topology, int max_links) {
             topology[link_count].from_id = node_id;
             topology[link_count].to_id = neighbor_table[i].neighbor_id;
             topology[link_count].cost = 1;  // Standard OLSR cost
-            topology[link_count].validity = neighbor_table[i].last_seen + 10;
+            topology[link_count].validity = neighbor_table[i].last_seen + NEIGHB_HOLD_TIME;
             link_count++;
             direct_links++;
             
@@ -301,70 +1294,28 @@ int build_topology_graph(struct topology_link* topology, int max_links) {
     // Step 2: Clean up expired topology links
     cleanup_topology_links();
     
-    // Step 3: Add all valid topology links from global database (multi-hop)
-    struct topology_link global_links[MAX_TOPOLOGY_LINKS];
-    int global_count = get_all_topology_links(global_links, MAX_TOPOLOGY_LINKS);
+    // Step 3: Add all valid topology links from global database (multi-hop).
+    // Each originator's set is duplicate-free; a TC link that repeats a
+    // direct link is kept as a parallel arc, matching the incremental SPT.
+    int tc_links_added = get_all_topology_links(topology + link_count, max_links - link_count);
     
-    if (global_count > 0) {
-        printf("Using global topology database with %d links\n", global_count);
+    if (tc_links_added > 0) {
+        printf("Using global topology database with %d links\n", tc_links_added);
     } else {
         printf("No global topology links available\n");
     }
     
-    int tc_links_added = 0;
-    for (int i = 0; i < global_count && link_count < max_links; i++) {
-        // Avoid duplicate links (check if already added as direct link)
-        int is_duplicate = 0;
-        for (int j = 0; j < link_count; j++) {
-            if (topology[j].from_id == global_links[i].from_id &&
-                topology[j].to_id == global_links[i].to_id) {
-                is_duplicate = 1;
-                break;
-            }
-        }
-        
-        if (!is_duplicate) {
-            topology[link_count].from_id = global_links[i].from_id;
-            topology[link_count].to_id = global_links[i].to_id;
-            topology[link_count].cost = 1;  // Standard OLSR cost
-            topology[link_count].validity = global_links[i].validity;
-            link_count++;
-            tc_links_added++;
-            
-            char from_str[16], to_str[16];
-            printf("Global link: %s -> %s (cost=1)\n",
-                   id_to_string(global_links[i].from_id, from_str),
-                   id_to_string(global_links[i].to_id, to_str));
-        }
-    }
-    
-    // Step 4: Also add legacy TC topology for backward compatibility
-    cleanup_tc_topology();
-    int legacy_tc_added = 0;
-    for (int i = 0; i < tc_topology_size && link_count < max_links; i++) {
-        if (tc_topology[i].validity > now) {
-            // Check if this link is already in the topology
-            int is_duplicate = 0;
-            for (int j = 0; j < link_count; j++) {
-                if (topology[j].from_id == tc_topology[i].from_id &&
-                    topology[j].to_id == tc_topology[i].to_id) {
-                    is_duplicate = 1;
-                    break;
-                }
-            }
-            
-            if (!is_duplicate) {
-                topology[link_count] = tc_topology[i];
-                link_count++;
-                legacy_tc_added++;
-            }
-        }
+    for (int i = link_count; i < link_count + tc_links_added; i++) {
+        char from_str[16], to_str[16];
+        printf("Global link: %s -> %s (cost=1)\n",
+               id_to_string(topology[i].from_id, from_str),
+               id_to_string(topology[i].to_id, to_str));
     }
+    link_count += tc_links_added;
     
     printf("\nTopology Summary:\n");
     printf("  Direct neighbors: %d\n", direct_links);
     printf("  Global TC links:  %d\n", tc_links_added);
-    printf("  Legacy TC links:  %d\n", legacy_tc_added);
     printf("  Total links:      %d\n", link_count);
     printf("=== TOPOLOGY GRAPH COMPLETE ===\n\n");
     
@@ -373,90 +1324,128 @@ int build_topology_graph(struct topology_link* topology, int max_links) {
 
 /**
  * @brief Apply Dijkstra's algorithm for shortest path calculation
+ *
+ * The link array is first converted into a compressed-sparse-row adjacency
+ * over dense vertex indices, then a binary-heap Dijkstra runs over it. The
+ * first hop of every path is propagated during relaxation, so next hops are
+ * known without walking parent chains. Cost is O((V + L) log L).
+ *
+ * The resulting tree also seeds the incremental engine used by
+ * routing_link_added() and routing_link_removed().
  */
 void dijkstra_shortest_path(uint32_t source, struct topology_link* topology, int link_count) {
-    // Build list of unique nodes
-    uint32_t nodes[MAX_NODES];
-    int node_count = 0;
-    
-    // Add source node
-    nodes[node_count++] = source;
-    
-    // Add all nodes from topology links
-    for (int i = 0; i < link_count && node_count < MAX_NODES; i++) {
-        if (-1 == find_node_index(nodes, node_count, topology[i].from_id)) {
-            nodes[node_count++] = topology[i].from_id;
+    if (link_count < 0) {
+        link_count = 0;
+    }
+    spt.valid = 0;
+    if (spt_reserve_links(link_count) != 0 ||
+        spt_reserve_heap(link_count + 1) != 0 ||
+        spt_reset(source) == -1) {
+        printf("Error: Out of memory for shortest path calculation\n");
+        routing_dirty = 1;
+        return;
+    }
+    int src_index = spt.src_index;
+
+    // Resolve link endpoints to vertex indices, counting distinct nodes
+    int unique_nodes = 1;
+    spt.touched[src_index] = 1;
+    for (int i = 0; i < link_count; i++) {
+        int u = spt_vertex(topology[i].from_id);
+        int v = spt_vertex(topology[i].to_id);
+        if (u == -1 || v == -1) {
+            printf("Error: Out of memory for shortest path calculation\n");
+            routing_dirty = 1;
+            memset(spt.touched, 0, (size_t)spt.node_count);
+            return;
         }
-        if (-1 == find_node_index(nodes, node_count, topology[i].to_id)) {
-            nodes[node_count++] = topology[i].to_id;
+        spt.edge_src[i] = u;
+        if (!spt.touched[u]) {
+            spt.touched[u] = 1;
+            unique_nodes++;
+        }
+        if (!spt.touched[v]) {
+            spt.touched[v] = 1;
+            unique_nodes++;
         }
     }
-    
-    printf("Dijkstra: Found %d unique nodes in topology\n", node_count);
-    
-    // Initialize arrays
-    int dist[MAX_NODES];
-    int sptSet[MAX_NODES];
-    uint32_t parent[MAX_NODES];
-    
-    for (int i = 0; i < node_count; i++) {
-        dist[i] = INFINITE_COST;
-        sptSet[i] = 0;
-        parent[i] = 0;
-    }
-    // Find source index
-    int src_index = find_node_index(nodes, node_count, source);
-    if (-1 == src_index) {
-        printf("Error: Source node not found in topology\n");
-        return;
+    memset(spt.touched, 0, (size_t)spt.node_count);
+    int node_count = spt.node_count;
+
+    printf("Dijkstra: Found %d unique nodes in topology\n", unique_nodes);
+
+    // Build CSR adjacency with a counting pass over the source vertices
+    int* offsets = spt.offsets;
+    memset(offsets, 0, (size_t)(node_count + 1) * sizeof(int));
+    for (int i = 0; i < link_count; i++) {
+        offsets[spt.edge_src[i] + 1]++;
     }
-    
-    dist[src_index] = 0;
-    
+    for (int v = 0; v < node_count; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    // Fill arcs using offsets[u] as the insertion cursor, then shift back
+    for (int i = 0; i < link_count; i++) {
+        int pos = offsets[spt.edge_src[i]]++;
+        spt.targets[pos] = spt_lookup(topology[i].to_id);
+        spt.costs[pos] = topology[i].cost;
+    }
+    for (int v = node_count; v > 0; v--) {
+        offsets[v] = offsets[v - 1];
+    }
+    offsets[0] = 0;
+
     // Main Dijkstra loop
-    for (int count = 0; count < node_count - 1; count++) {
-        int u = find_min_distance(dist, sptSet, node_count);
-        if (-1 == u) break;
-        
-        sptSet[u] = 1;
-        
-        // Update distances to adjacent nodes
-        for (int i = 0; i < link_count; i++) {
-            if (topology[i].from_id == nodes[u]) {
-                int v = find_node_index(nodes, node_count, topology[i].to_id);
-                if (v != -1 && !sptSet[v] && dist[u] != INFINITE_COST) {
-                    int new_dist = dist[u] + topology[i].cost;
-                    if (new_dist < dist[v]) {
-                        dist[v] = new_dist;
-                        parent[v] = nodes[u];
-                    }
-                }
+    int* dist = spt.dist;
+    int* hops = spt.hops;
+    int* first_hop = spt.first_hop;
+    int heap_size = 0;
+    spt_heap_push(&heap_size, 0, src_index);
+
+    while (heap_size > 0) {
+        struct spt_heap_item item = spt_heap_pop(&heap_size);
+        int u = item.vertex;
+        if (item.dist != dist[u]) {
+            continue;  // Stale entry, vertex already settled closer
+        }
+
+        for (int a = offsets[u]; a < offsets[u + 1]; a++) {
+            int v = spt.targets[a];
+            int cost = spt.costs[a];
+            if (cost < 0 || dist[u] > INFINITE_COST - cost) {
+                continue;
+            }
+            int new_dist = dist[u] + cost;
+            if (new_dist < dist[v]) {
+                dist[v] = new_dist;
+                hops[v] = hops[u] + 1;
+                first_hop[v] = (u == src_index) ? v : first_hop[u];
+                spt.parent[v] = u;
+                spt_heap_push(&heap_size, new_dist, v);
             }
         }
     }
-    
+
     // Update routing table with results
     clear_routing_table();
-    
+
     for (int i = 0; i < node_count; i++) {
-        if (nodes[i] != source && dist[i] != INFINITE_COST) {
-            // Trace back to find next hop
-            uint32_t next_hop = nodes[i];
-            uint32_t current = nodes[i];
-            
-            while (parent[find_node_index(nodes, node_count, current)] != source &&
-                   parent[find_node_index(nodes, node_count, current)] != 0) {
-                current = parent[find_node_index(nodes, node_count, current)];
-                next_hop = current;
-            }
-            
-            if (parent[find_node_index(nodes, node_count, current)] == source) {
-                next_hop = current;
-            }
-            
-            add_routing_entry(nodes[i], next_hop, dist[i], dist[i]);
+        if (i != src_index && dist[i] != INFINITE_COST) {
+            add_routing_entry(node_id_of(i), node_id_of(first_hop[i]), dist[i], hops[i]);
+        }
+    }
+
+    // Seed the mutable adjacency for incremental updates
+    for (int i = 0; i < link_count; i++) {
+        int u = spt.edge_src[i];
+        int v = spt_lookup(topology[i].to_id);
+        if (spt_adj_push(&spt.out[u], v) != 0 || spt_adj_push(&spt.in[v], u) != 0) {
+            spt_fail();
+            return;
         }
     }
+    spt.arc_count = link_count;
+    spt.valid = 1;
+    routing_dirty = 0;
 }
 
 /**
@@ -475,9 +1464,20 @@ void calculate_routing_table(void) {
     char node_str[16];
     printf("Source node: %s\n", id_to_string(node_id, node_str));
     
+    // The tree is rebuilt from scratch, so link deltas seen while building
+    // the graph must not be applied to the old one
+    spt.valid = 0;
+    
     // Build complete network topology
-    struct topology_link topology[MAX_NODES * MAX_NODES];
-    int link_count = build_topology_graph(topology, MAX_NODES * MAX_NODES);
+    int max_links = neighbor_count + topology_link_count;
+    struct topology_link* topology = (struct topology_link*)malloc(
+        (size_t)(max_links > 0 ? max_links : 1) * sizeof(struct topology_link));
+    if (!topology) {
+        printf("Error: Out of memory for topology graph\n");
+        routing_dirty = 1;
+        return;
+    }
+    int link_count = build_topology_graph(topology, max_links);
     
     if (link_count > 0) {
         printf("Running Dijkstra with %d topology links...\n", link_count);
@@ -485,9 +1485,15 @@ void calculate_routing_table(void) {
         print_routing_table();
     } else {
         clear_routing_table();
+        if (spt_reset(node_id) != -1) {
+            spt.valid = 1;
+            routing_dirty = 0;
+        }
         printf("No topology links found - network disconnected or no neighbors\n");
     }
+    free(topology);
     
+    publish_routing_snapshot();
     printf("=== ROUTING CALCULATION COMPLETE ===\n\n");
 }
 
@@ -496,41 +1502,83 @@ void calculate_routing_table(void) {
  */
 int add_routing_entry(uint32_t dest_id, uint32_t next_hop_id, uint32_t metric, int hops) {
     // Check if entry already exists
-    for (int i = 0; i < routing_table_size; i++) {
-        if (routing_table[i].dest_id == dest_id) {
-            // Update existing entry
-            routing_table[i].next_hop_id = next_hop_id;
-            routing_table[i].metric = metric;
-            routing_table[i].hops = hops;
-            routing_table[i].timestamp = time(NULL);
-            
-            char dest_str[16], next_hop_str[16];
-            printf("Updated route: %s via %s (cost=%u, hops=%d)\n",
-                   id_to_string(dest_id, dest_str),
-                   id_to_string(next_hop_id, next_hop_str),
-                   metric, hops);
-            return 0;
+    int i = find_route_index(dest_id);
+    if (i != -1) {
+        // Update existing entry
+        if (routing_table[i].next_hop_id != next_hop_id) {
+            routing_table[i].next_hop_entry = NULL;
         }
-    }
-    
-    // Add new entry if space available
-    if (routing_table_size < MAX_ROUTING_ENTRIES) {
-        routing_table[routing_table_size].dest_id = dest_id;
-        routing_table[routing_table_size].next_hop_id = next_hop_id;
-        routing_table[routing_table_size].metric = metric;
-        routing_table[routing_table_size].hops = hops;
-        routing_table[routing_table_size].timestamp = time(NULL);
-        routing_table_size++;
+        routing_table[i].next_hop_id = next_hop_id;
+        routing_table[i].metric = metric;
+        routing_table[i].hops = hops;
+        routing_table[i].timestamp = olsr_clock_now();
+        snapshot_dirty = 1;
         
         char dest_str[16], next_hop_str[16];
-        printf("Added route: %s via %s (cost=%u, hops=%d)\n",
+        printf("Updated route: %s via %s (cost=%u, hops=%d)\n",
                id_to_string(dest_id, dest_str),
                id_to_string(next_hop_id, next_hop_str),
                metric, hops);
         return 0;
     }
     
-    return -1;  // Table full
+    // Grow the table if needed
+    if (routing_table_size >= routing_table_capacity) {
+        int capacity = routing_table_capacity > 0 ? 2 * routing_table_capacity : MAX_ROUTING_ENTRIES;
+        struct routing_table_entry* grown = (struct routing_table_entry*)realloc(
+            routing_table, (size_t)capacity * sizeof(struct routing_table_entry));
+        if (!grown) {
+            printf("Error: Failed to grow routing table\n");
+            return -1;
+        }
+        routing_table = grown;
+        routing_table_capacity = capacity;
+    }
+    
+    // Add new entry
+    struct routing_table_entry* entry = &routing_table[routing_table_size];
+    memset(entry, 0, sizeof(struct routing_table_entry));
+    entry->dest_id = dest_id;
+    entry->next_hop_id = next_hop_id;
+    entry->metric = metric;
+    entry->hops = hops;
+    entry->timestamp = olsr_clock_now();
+    if (index_route_position(routing_table_size) != 0) {
+        printf("Error: Failed to index routing entry\n");
+        return -1;
+    }
+    routing_table_size++;
+    snapshot_dirty = 1;
+    
+    char dest_str[16], next_hop_str[16];
+    printf("Added route: %s via %s (cost=%u, hops=%d)\n",
+           id_to_string(dest_id, dest_str),
+           id_to_string(next_hop_id, next_hop_str),
+           metric, hops);
+    return 0;
+}
+
+/**
+ * @brief Remove a routing table entry
+ * @param dest_id Destination node ID
+ * @return 0 on success, -1 if no entry exists
+ */
+static int remove_routing_entry(uint32_t dest_id) {
+    int i = find_route_index(dest_id);
+    if (i == -1) {
+        return -1;
+    }
+    
+    routing_table[i] = routing_table[--routing_table_size];
+    memset(&routing_table[routing_table_size], 0, sizeof(struct routing_table_entry));
+    if (i < routing_table_size) {
+        index_route_position(i);
+    }
+    snapshot_dirty = 1;
+    
+    char dest_str[16];
+    printf("Removed route: %s\n", id_to_string(dest_id, dest_str));
+    return 0;
 }
 
 /**
@@ -538,18 +1586,18 @@ int add_routing_entry(uint32_t dest_id, uint32_t next_hop_id, uint32_t metric, i
  */
 void print_routing_table(void) {
     printf("\n=== Routing Table ===\n");
-    printf("%-15s %-15s %-8s %-8s %-8s\n", "Destination", "Next Hop", "Cost", "Hops", "Age(s)");
+    printf("%-15s %-15s %-8s %-8s %-8s\n", "Destination", "Next Hop", "Cost", "Hops", "Age(ms)");
     printf("---------------------------------------------------------------\n");
     
-    time_t now = time(NULL);
+    olsr_time_t now = olsr_clock_now();
     for (int i = 0; i < routing_table_size; i++) {
         char dest_str[16], next_hop_str[16];
-        printf("%-15s %-15s %-8u %-8d %-8ld\n",
+        printf("%-15s %-15s %-8u %-8d %-8lld\n",
                id_to_string(routing_table[i].dest_id, dest_str),
                id_to_string(routing_table[i].next_hop_id, next_hop_str),
                routing_table[i].metric,
                routing_table[i].hops,
-               (long)(now - routing_table[i].timestamp));
+               (long long)(now - routing_table[i].timestamp));
     }
     printf("Total entries: %d\n\n", routing_table_size);
 }
@@ -558,8 +1606,9 @@ void print_routing_table(void) {
  * @brief Clear routing table
  */
 void clear_routing_table(void) {
+    // Stale route positions are rejected by find_route_index()
     routing_table_size = 0;
-    memset(routing_table, 0, sizeof(routing_table));
+    snapshot_dirty = 1;
     printf("Routing table cleared\n");
 }
 
@@ -576,6 +1625,20 @@ void update_routing_table(void) {
     calculate_routing_table();
 }
 
+/**
+ * @brief Bring the routing table up to date after topology changes
+ * 
+ * Link additions, removals and expiries (driven by the timer wheel) are
+ * normally applied to the shortest path tree as they happen, so this
+ * only falls back to a full recalculation when some change could not be
+ * applied in place.
+ */
+void refresh_routing_table(void) {
+    if (routing_dirty || !spt.valid || spt.source != node_id) {
+        update_routing_table();
+    }
+}
+
 /**
  * @brief Notify RRC layer about link failure or destination unreachability
  * 
@@ -644,17 +1707,8 @@ int get_next_hop(uint32_t dest_id, uint32_t* next_hop_id, uint32_t* metric, int*
         return 1;  // Special return code: destination is self
     }
     
-    // Search for the destination in routing table
-    struct routing_table_entry* route = NULL;
-    int route_index = -1;
-    
-    for (int i = 0; i < routing_table_size; i++) {
-        if (routing_table[i].dest_id == dest_id) {
-            route = &routing_table[i];
-            route_index = i;
-            break;
-        }
-    }
+    // Look up the destination in routing table
+    struct routing_table_entry* route = get_routing_entry(dest_id);
     
     if (!route) {
         // No route exists at all
@@ -668,28 +1722,22 @@ int get_next_hop(uint32_t dest_id, uint32_t* next_hop_id, uint32_t* metric, int*
     uint32_t planned_next_hop = route->next_hop_id;
     
     // Verify next hop neighbor is still alive and reachable
-    struct neighbor_entry* next_hop_neighbor = NULL;
-    for (int i = 0; i < neighbor_count; i++) {
-        if (neighbor_table[i].neighbor_id == planned_next_hop) {
-            next_hop_neighbor = &neighbor_table[i];
-            break;
-        }
-    }
+    struct neighbor_entry* next_hop_neighbor = route_next_hop_neighbor(route);
     
-    time_t now = time(NULL);
+    olsr_time_t now = olsr_clock_now();
     int next_hop_valid = 0;
     
     if (next_hop_neighbor) {
         // Check if neighbor is still alive (seen recently)
-        time_t silence_duration = now - next_hop_neighbor->last_seen;
+        olsr_time_t silence_duration = now - next_hop_neighbor->last_seen;
         
         if (silence_duration < NEIGHB_HOLD_TIME) {
             // Next hop is still valid
             next_hop_valid = 1;
         } else {
             char next_hop_str[16];
-            printf("LINK_FAILURE: Next hop %s has timed out (silent for %lds)\n",
-                   id_to_string(planned_next_hop, next_hop_str), silence_duration);
+            printf("LINK_FAILURE: Next hop %s has timed out (silent for %lld ms)\n",
+                   id_to_string(planned_next_hop, next_hop_str), (long long)silence_duration);
         }
     } else {
         char next_hop_str[16];
@@ -706,24 +1754,13 @@ int get_next_hop(uint32_t dest_id, uint32_t* next_hop_id, uint32_t* metric, int*
         int dest_exists_in_network = 0;
         
         // Check direct neighbors
-        for (int i = 0; i < neighbor_count; i++) {
-            if (neighbor_table[i].neighbor_id == dest_id) {
-                dest_exists_in_network = 1;
-                break;
-            }
+        if (find_neighbor(dest_id)) {
+            dest_exists_in_network = 1;
         }
         
         // Check global topology database
         if (!dest_exists_in_network) {
-            struct topology_link topology[MAX_TOPOLOGY_LINKS];
-            int link_count = get_all_topology_links(topology, MAX_TOPOLOGY_LINKS);
-            
-            for (int i = 0; i < link_count; i++) {
-                if (topology[i].from_id == dest_id || topology[i].to_id == dest_id) {
-                    dest_exists_in_network = 1;
-                    break;
-                }
-            }
+            dest_exists_in_network = topology_has_node(dest_id);
         }
         
         if (!dest_exists_in_network) {
@@ -744,19 +1781,16 @@ int get_next_hop(uint32_t dest_id, uint32_t* next_hop_id, uint32_t* metric, int*
                id_to_string(dest_id, dest_str));
         
         // Invalidate the current route
-        routing_table[route_index].metric = 0xFFFFFFFF;  // Mark as invalid
+        route->metric = 0xFFFFFFFF;  // Mark as invalid
+        snapshot_dirty = 1;
         
         // Trigger immediate routing table recalculation
         update_routing_table();
         
         // Try to find new route after recalculation
-        route = NULL;
-        for (int i = 0; i < routing_table_size; i++) {
-            if (routing_table[i].dest_id == dest_id && 
-                routing_table[i].metric != 0xFFFFFFFF) {
-                route = &routing_table[i];
-                break;
-            }
+        route = get_routing_entry(dest_id);
+        if (route && route->metric == 0xFFFFFFFF) {
+            route = NULL;
         }
         
         if (!route) {
@@ -799,12 +1833,7 @@ int get_next_hop(uint32_t dest_id, uint32_t* next_hop_id, uint32_t* metric, int*
  * @return 1 if route exists, 0 otherwise
  */
 int has_route_to(uint32_t dest_id) {
-    for (int i = 0; i < routing_table_size; i++) {
-        if (routing_table[i].dest_id == dest_id) {
-            return 1;  // Route exists
-        }
-    }
-    return 0;  // No route found
+    return (find_route_index(dest_id) != -1) ? 1 : 0;
 }
 
 /**
@@ -813,10 +1842,53 @@ int has_route_to(uint32_t dest_id) {
  * @return Pointer to routing entry or NULL if not found
  */
 struct routing_table_entry* get_routing_entry(uint32_t dest_id) {
-    for (int i = 0; i < routing_table_size; i++) {
-        if (routing_table[i].dest_id == dest_id) {
-            return &routing_table[i];  // Return pointer to entry
+    int i = find_route_index(dest_id);
+    return (i != -1) ? &routing_table[i] : NULL;
+}
+
+/**
+ * @brief Look up a route in the published routing snapshot
+ * 
+ * Safe to call from any thread concurrently with routing updates. The
+ * entry is copied out, so the caller never holds a reference into a
+ * buffer the writer may later reuse.
+ */
+int lookup_route(uint32_t dest_id, struct routing_table_entry* route) {
+    if (dest_id == node_id) {
+        return 1;
+    }
+    
+    struct routing_snapshot* snap;
+    for (;;) {
+        snap = __atomic_load_n(&current_snapshot, __ATOMIC_SEQ_CST);
+        if (!snap) {
+            return -1;  // Nothing published yet
+        }
+        __atomic_add_fetch(&snap->readers, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&current_snapshot, __ATOMIC_SEQ_CST) == snap) {
+            break;
         }
+        // Swapped out before we registered; the writer may be refilling it
+        __atomic_sub_fetch(&snap->readers, 1, __ATOMIC_SEQ_CST);
     }
-    return NULL;  // Entry not found
-}
\ No newline at end of file
+    
+    int result = -1;
+    if (snap->size > 0) {
+        unsigned int slot = snapshot_slot(snap, dest_id);
+        while (snap->slots[slot] != -1) {
+            const struct routing_table_entry* entry = &snap->entries[snap->slots[slot]];
+            if (entry->dest_id == dest_id) {
+                if (entry->metric != 0xFFFFFFFF) {
+                    *route = *entry;
+                    route->next_hop_entry = NULL;  // Owned by the protocol thread
+                    result = 0;
+                }
+                break;
+            }
+            slot = (slot + 1) & (unsigned int)(snap->slot_capacity - 1);
+        }
+    }
+    
+    __atomic_sub_fetch(&snap->readers, 1, __ATOMIC_SEQ_CST);
+    return result;
+}
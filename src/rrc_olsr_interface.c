@@ -19,9 +19,7 @@ extern uint32_t node_id;
 extern struct control_queue global_ctrl_queue;
 
 // Forward declarations of your OLSR functions
-extern int get_next_hop(uint32_t dest_id, uint32_t* next_hop_id, uint32_t* metric, int* hops);
-extern void update_routing_table(void);
-extern void send_tc_message(struct control_queue* queue);
+extern void init_olsr(void);
 
 /**
  * @brief Convert 8-bit node ID (RRC format) to 32-bit node ID (OLSR format)
@@ -44,6 +42,10 @@ static uint8_t convert_node_id_from_olsr(uint32_t olsr_node_id) {
 /**
  * @brief Process route request from RRC layer
  * This is called by the OLSR thread when it receives MSG_OLSR_ROUTE_REQUEST
+ *
+ * Answered here from the routing snapshot only: this thread never touches
+ * the live routing table. An unknown destination is answered "no route"
+ * at once, and the protocol loop is asked to originate a TC.
  */
 static void process_rrc_route_request(LayerMessage* msg) {
     uint8_t dest_rrc = msg->data.olsr_route_req.destination_node;
@@ -57,53 +59,37 @@ static void process_rrc_route_request(LayerMessage* msg) {
     uint32_t dest_olsr = convert_node_id_to_olsr(dest_rrc);
     printf("Destination (OLSR format): 0x%08X\n", dest_olsr);
     
-    // Use your OLSR get_next_hop function
-    uint32_t next_hop_olsr = 0;
-    uint32_t metric = 0;
-    int hops = 0;
-    
-    int result = get_next_hop(dest_olsr, &next_hop_olsr, &metric, &hops);
+    // Answer from the published routing snapshot so this thread never
+    // sees a table that is being rebuilt
+    struct routing_table_entry route;
+    int result = lookup_route(dest_olsr, &route);
     
     // Prepare response
     LayerMessage response;
     response.type = MSG_OLSR_ROUTE_RESPONSE;
     response.data.olsr_route_resp.request_id = req_id;
     response.data.olsr_route_resp.destination_node = dest_rrc;
-    while(1){
-        if (result == 1) {
-            // Destination is self
-            printf("OLSR-RRC: Destination is this node\n");
-            response.data.olsr_route_resp.next_hop_node = convert_node_id_from_olsr(node_id);
-            response.data.olsr_route_resp.hop_count = 0;
-            break;
-        } else if (result == 0) {
-            // Route found
-            uint8_t next_hop_rrc = convert_node_id_from_olsr(next_hop_olsr);
-            printf("OLSR-RRC: Route found - next_hop=%u (OLSR: 0x%08X), hops=%d\n", 
-                next_hop_rrc, next_hop_olsr, hops);
-            
-            response.data.olsr_route_resp.next_hop_node = next_hop_rrc;
-            response.data.olsr_route_resp.hop_count = (uint8_t)hops;
-            break;
-        } else if (result == -2) {
-            // Destination unreachable (node left network or link failure)
-            printf("OLSR-RRC: Destination unreachable (node left network)\n");
-            response.data.olsr_route_resp.next_hop_node = 0xFF;  // No route
-            response.data.olsr_route_resp.hop_count = 0xFF;
-            break;
-        } else {
-            // No route found - trigger route discovery
-            printf("OLSR-RRC: No route found, triggering route discovery\n");
-            response.data.olsr_route_resp.next_hop_node = 0xFF;  // No route
-            response.data.olsr_route_resp.hop_count = 0xFF;
-            
-            // Trigger TC message broadcast for route discovery
-            send_tc_message(&global_ctrl_queue);
-            result = get_next_hop(dest_olsr, &next_hop_olsr, &metric, &hops);
-        }
+    if (result == 1) {
+        // Destination is self
+        printf("OLSR-RRC: Destination is this node\n");
+        response.data.olsr_route_resp.next_hop_node = convert_node_id_from_olsr(node_id);
+        response.data.olsr_route_resp.hop_count = 0;
+    } else if (result == 0) {
+        // Route found
+        uint8_t next_hop_rrc = convert_node_id_from_olsr(route.next_hop_id);
+        printf("OLSR-RRC: Route found - next_hop=%u (OLSR: 0x%08X), hops=%d\n", 
+            next_hop_rrc, route.next_hop_id, route.hops);
+        
+        response.data.olsr_route_resp.next_hop_node = next_hop_rrc;
+        response.data.olsr_route_resp.hop_count = (uint8_t)route.hops;
+    } else {
+        // No route found - the RRC asks again once topology has spread
+        printf("OLSR-RRC: No route found, asking the protocol loop for a TC\n");
+        response.data.olsr_route_resp.next_hop_node = 0xFF;  // No route
+        response.data.olsr_route_resp.hop_count = 0xFF;
+        request_tc_message();
     }
     
-    
     // Send response back to RRC
     if (message_queue_enqueue(&olsr_to_rrc_queue, &response, 5000)) {
         printf("OLSR-RRC: Route response sent successfully\n");
@@ -114,6 +100,15 @@ static void process_rrc_route_request(LayerMessage* msg) {
     printf("=========================================\n\n");
 }
 
+/**
+ * @brief OLSR protocol thread: runs the protocol loop, which never returns
+ */
+static void* olsr_protocol_thread(void* arg) {
+    (void)arg;
+    init_olsr();
+    return NULL;
+}
+
 /**
  * @brief OLSR Layer Thread - Integrated with your OLSR implementation
  * This replaces the skeleton thread provided by RRC team
@@ -128,8 +123,13 @@ void* olsr_layer_thread(void* arg) {
     printf("OLSR-RRC: Thread started for node %u (OLSR: 0x%08X)\n", 
            my_node_id_rrc, node_id);
     
-    // Initialize your OLSR protocol
-    init_olsr();
+    // Run the protocol loop on its own thread; this one only serves the RRC
+    pthread_t protocol_thread;
+    if (pthread_create(&protocol_thread, NULL, olsr_protocol_thread, NULL) != 0) {
+        fprintf(stderr, "OLSR-RRC: Failed to create protocol thread\n");
+        return NULL;
+    }
+    pthread_detach(protocol_thread);
     
     printf("OLSR-RRC: Waiting for route requests from RRC...\n");
     
@@ -148,20 +148,8 @@ void* olsr_layer_thread(void* arg) {
             }
         }
         
-        // Periodic OLSR maintenance (run every second)
-        // This keeps your OLSR protocol running in the background
-        static time_t last_maintenance = 0;
-        time_t now = time(NULL);
-        
-        if (now - last_maintenance >= 1) {
-            // Perform periodic tasks
-            cleanup_neighbor_table();
-            cleanup_tc_topology();
-            cleanup_duplicate_table();
-            cleanup_topology_links();
-            
-            last_maintenance = now;
-        }
+        // Soft-state expiry runs in the protocol loop (init_olsr()), the only
+        // thread that may touch the timer wheel and the tables it expires
     }
     
     return NULL;
@@ -0,0 +1,241 @@
+/**
+ * @file slot_alloc.c
+ * @brief Distributed TDMA slot allocation
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "../include/slot_alloc.h"
+#include "../include/hello.h"
+#include "../include/olsr.h"
+
+/** @brief Fixed-point scale of the load average */
+#define LOAD_SCALE 16
+
+/** @brief Current allocation state (SLOT_ALLOC_*) */
+static int alloc_state = SLOT_ALLOC_DISABLED;
+/** @brief Slots the engine last saw this node holding */
+static struct slot_set alloc_slots;
+/** @brief Backoff rounds left, or collision-free rounds while tentative */
+static int alloc_rounds = 0;
+/** @brief xorshift32 state, seeded from the node ID so neighbors diverge */
+static uint32_t alloc_random = 0;
+
+/** @brief Average messages originated and relayed per HELLO round, times LOAD_SCALE */
+static uint32_t alloc_load = 0;
+/** @brief Control queue counter at the previous round */
+static uint32_t last_queued = 0;
+/** @brief Data messages forwarded since the previous round; bumped from the receive path */
+static uint32_t forwarded = 0;
+/** @brief Slots the load called for at the previous round, for logging */
+static int alloc_wanted = 1;
+
+/**
+ * @brief Convert a node ID to a string representation
+ */
+static char* id_to_string(uint32_t id, char* buffer) {
+    unsigned char* bytes = (unsigned char*)&id;
+    snprintf(buffer, 16, "%d.%d.%d.%d", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return buffer;
+}
+
+/**
+ * @brief Next pseudo-random number
+ */
+static uint32_t next_random(void) {
+    if (alloc_random == 0) {
+        alloc_random = (node_id * 2654435761u) | 1;
+    }
+    alloc_random ^= alloc_random << 13;
+    alloc_random ^= alloc_random >> 17;
+    alloc_random ^= alloc_random << 5;
+    return alloc_random;
+}
+
+/**
+ * @brief Wait a random number of rounds before picking slots
+ */
+static void start_backoff(void) {
+    alloc_state = SLOT_ALLOC_BACKOFF;
+    alloc_rounds = 1 + (int)(next_random() % SLOT_MAX_BACKOFF);
+}
+
+/**
+ * @brief Fold the last round's traffic into the load average
+ * @return Slots the load calls for, 1..SLOT_MAX_PER_NODE
+ */
+static int measure_demand(const struct control_queue* queue) {
+    uint32_t sent = __atomic_exchange_n(&forwarded, 0, __ATOMIC_RELAXED);
+    if (queue) {
+        uint32_t pushed = control_queue_pushed(queue);
+        sent += pushed - last_queued;
+        last_queued = pushed;
+    }
+
+    // Exponential average over about four rounds, so one burst does not
+    // make the node grab slots it gives back a round later
+    alloc_load = alloc_load - alloc_load / 4 + sent * LOAD_SCALE / 4;
+
+    uint32_t per_slot = SLOT_LOAD_PER_SLOT * LOAD_SCALE;
+    int wanted = 1 + (int)(alloc_load / per_slot);
+    if (wanted > SLOT_MAX_PER_NODE) {
+        wanted = SLOT_MAX_PER_NODE;
+    }
+    if (wanted != alloc_wanted) {
+        printf("Send load (own + relayed) %u.%02u msgs/round -> %d TDMA slot(s)\n",
+               alloc_load / LOAD_SCALE, (alloc_load % LOAD_SCALE) * 100 / LOAD_SCALE, wanted);
+        alloc_wanted = wanted;
+    }
+    return wanted;
+}
+
+/**
+ * @brief Pick a free slot not already in a set, starting at a random slot
+ * @return Slot number, or -1 if none is free
+ */
+static int pick_free_slot(const struct slot_set* taken) {
+    int start = (int)(next_random() % MAX_TDMA_SLOTS);
+    int slot = find_free_slot(start);
+    while (slot >= 0 && slot_set_has(taken, slot)) {
+        slot = find_free_slot(slot + 1);
+    }
+    if (slot < 0) {
+        slot = find_free_slot(0);
+        while (slot >= 0 && slot < start && slot_set_has(taken, slot)) {
+            slot = find_free_slot(slot + 1);
+        }
+        if (slot >= start) {
+            slot = -1;
+        }
+    }
+    return slot;
+}
+
+void slot_alloc_note_forwarded(void) {
+    __atomic_add_fetch(&forwarded, 1, __ATOMIC_RELAXED);
+}
+
+void slot_alloc_enable(int enabled) {
+    if (!enabled) {
+        alloc_state = SLOT_ALLOC_DISABLED;
+        return;
+    }
+    if (alloc_state != SLOT_ALLOC_DISABLED) {
+        return;
+    }
+    alloc_slots = *get_my_reserved_slots();
+    if (slot_set_count(&alloc_slots) > 0) {
+        alloc_state = SLOT_ALLOC_OWNED;
+    } else {
+        start_backoff();
+    }
+}
+
+int slot_alloc_run(const struct control_queue* queue) {
+    int wanted = measure_demand(queue);
+    if (alloc_state == SLOT_ALLOC_DISABLED) {
+        return slot_set_count(get_my_reserved_slots());
+    }
+
+    const struct slot_set* mine = get_my_reserved_slots();
+    if (!slot_set_equal(mine, &alloc_slots)) {
+        // Set or cleared from outside (e.g. by the RRC): adopt it
+        alloc_slots = *mine;
+        if (slot_set_count(&alloc_slots) > 0) {
+            alloc_state = SLOT_ALLOC_OWNED;
+        } else {
+            start_backoff();
+        }
+    }
+
+    // Collisions, slot by slot: a node within two hops announces the same
+    // slot. The lower ID keeps it; this node gives up only that slot.
+    struct slot_set kept = alloc_slots;
+    int lost = 0;
+    for (int slot = slot_set_first(&alloc_slots); slot >= 0; slot = slot_set_next(&alloc_slots, slot)) {
+        uint32_t lowest;
+        if (count_slot_claims(slot, &lowest) > 0 && lowest < node_id) {
+            char node_str[16];
+            printf("Slot %d collides with node %s (lower ID keeps it) - releasing\n",
+                   slot, id_to_string(lowest, node_str));
+            slot_set_remove(&kept, slot);
+            lost++;
+        }
+    }
+
+    // Give back slots the load no longer needs, highest first
+    int held = slot_set_count(&kept);
+    while (held > wanted) {
+        int highest = slot_set_first(&kept);
+        for (int slot = highest; slot >= 0; slot = slot_set_next(&kept, slot)) {
+            highest = slot;
+        }
+        printf("Releasing slot %d (load needs %d)\n", highest, wanted);
+        slot_set_remove(&kept, highest);
+        held--;
+    }
+
+    if (!slot_set_equal(&kept, &alloc_slots)) {
+        set_my_slot_reservations(&kept);
+        alloc_slots = kept;
+    }
+    if (lost > 0) {
+        start_backoff();
+        return held;
+    }
+
+    if (alloc_state == SLOT_ALLOC_TENTATIVE) {
+        if (++alloc_rounds >= SLOT_CONFIRM_ROUNDS) {
+            alloc_state = SLOT_ALLOC_OWNED;
+            char slots_str[SLOT_SET_STRING_LEN];
+            printf("Slots %s confirmed\n", slot_set_format(&alloc_slots, slots_str));
+        }
+        return held;
+    }
+    if (held >= wanted) {
+        if (alloc_state == SLOT_ALLOC_BACKOFF && held > 0) {
+            // A collision release left enough slots: nothing to pick
+            alloc_state = SLOT_ALLOC_OWNED;
+        }
+        return held;
+    }
+
+    // More slots needed: wait a random number of rounds first, so
+    // neighbors that grow at the same time do not pick together
+    if (alloc_state == SLOT_ALLOC_OWNED) {
+        start_backoff();
+    }
+    if (--alloc_rounds > 0) {
+        return held;  // Still backing off
+    }
+
+    // Pick random free slots; a random start keeps simultaneous pickers apart
+    struct slot_set grown = alloc_slots;
+    while (held < wanted) {
+        int free_slot = pick_free_slot(&grown);
+        if (free_slot < 0) {
+            break;
+        }
+        slot_set_add(&grown, free_slot);
+        held++;
+    }
+    if (slot_set_equal(&grown, &alloc_slots)) {
+        printf("No free TDMA slot within two hops - retrying next round\n");
+        alloc_rounds = 1;
+        return held;
+    }
+
+    set_my_slot_reservations(&grown);
+    alloc_slots = grown;
+    alloc_state = SLOT_ALLOC_TENTATIVE;
+    alloc_rounds = 0;
+    char slots_str[SLOT_SET_STRING_LEN];
+    printf("Claimed slots %s (tentative)\n", slot_set_format(&grown, slots_str));
+    return held;
+}
+
+int slot_alloc_get_state(void) {
+    return alloc_state;
+}
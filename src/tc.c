@@ -8,7 +8,9 @@
 #include "../include/hello.h"
 #include "../include/routing.h"
 #include "../include/tc.h"
+#include "../include/node_index.h"
 #include "../include/mpr.h"
+#include "../include/event_loop.h"
 
 // Global routing functions are in routing.c
 // Forward declarations
@@ -16,7 +18,7 @@ int is_duplicate_message(uint32_t originator, uint16_t seq_number);
 int add_duplicate_entry(uint32_t originator, uint16_t seq_number);
 int should_forward_message(uint32_t sender_addr, uint32_t originator_addr);
 int forward_tc_message(struct olsr_message* msg, uint32_t sender_addr, struct control_queue* queue);
-int add_topology_link(uint32_t from_node, uint32_t to_node, uint16_t ansn, time_t validity_time);
+int add_topology_link(uint32_t from_node, uint32_t to_node, uint16_t ansn, olsr_time_t validity_time);
 extern struct control_queue global_ctrl_queue;
 
 /**
@@ -34,6 +36,42 @@ static char* id_to_string(uint32_t id, char* buffer) {
 /** @brief Global ANSN (Advertised Neighbor Sequence Number) counter */
 static uint16_t ansn_counter = 0;
 
+/** @brief Full TC for the current ANSN */
+static struct olsr_tc tc_full;
+/** @brief Delta TC from the previous ANSN to the current one */
+static struct olsr_tc tc_delta;
+
+/** @brief Selector lists of the current and previous generate_tc_message() call */
+static struct tc_neighbor* tc_lists[2] = { NULL, NULL };
+static int tc_list_capacity[2] = { 0, 0 };
+static int tc_list_count[2] = { 0, 0 };
+static int tc_current = 0;
+/** @brief Added and withdrawn selectors of tc_delta */
+static struct tc_neighbor* tc_added = NULL;
+static int tc_added_capacity = 0;
+static struct tc_neighbor* tc_removed = NULL;
+static int tc_removed_capacity = 0;
+
+/**
+ * @brief Per-node index: generation that last listed the node as a selector
+ * 
+ * Generations start at 2 so zero-filled entries never match the previous one.
+ */
+static uint32_t* tc_listed = NULL;
+static int tc_listed_capacity = 0;
+static uint32_t tc_generation = 1;
+
+/** @brief State of the last TC popped for transmission (see tc_message_transmitted()) */
+static int tc_sent = 0;
+static uint16_t tc_sent_ansn = 0;
+/** @brief When the last TC (full or delta) was transmitted */
+static olsr_time_t tc_sent_time = 0;
+/** @brief When the last full TC was transmitted */
+static olsr_time_t tc_full_sent_time = 0;
+
+/** @brief Set by request_tc_message() on any thread, taken by the protocol loop */
+static int tc_requested = 0;
+
 /**
  * @brief Process a received TC message
  * 
@@ -81,28 +119,56 @@ void process_tc_message(struct olsr_message* msg, uint32_t sender_addr) {
         return;
     }
     
-    printf("TC Content: ANSN=%d, MPR Selectors=%d\n", tc->ansn, tc->selector_count);
+    int is_delta = (tc->tc_type == TC_DELTA);
+    int removed_count = is_delta ? tc->removed_count : 0;
+    if (is_delta) {
+        printf("TC Content: ANSN=%d (delta from %d), Added=%d, Removed=%d\n",
+               tc->ansn, tc->base_ansn, tc->selector_count, tc->removed_count);
+    } else {
+        printf("TC Content: ANSN=%d, MPR Selectors=%d\n", tc->ansn, tc->selector_count);
+    }
     
     // Step 3: Process TC content - update global topology
-    time_t validity = time(NULL) + msg->vtime;
+    olsr_time_t validity = olsr_clock_now() + OLSR_SECONDS(msg->vtime);
     int topology_updated = 0;
     
-    for (int i = 0; i < tc->selector_count; i++) {
-        uint32_t selector = tc->mpr_selectors[i].neighbor_addr;
+    int total = tc->selector_count + removed_count;
+    uint32_t* advertised = (uint32_t*)malloc((size_t)(total > 0 ? total : 1) * sizeof(uint32_t));
+    if (advertised) {
+        for (int i = 0; i < tc->selector_count; i++) {
+            advertised[i] = tc->mpr_selectors[i].neighbor_addr;
+        }
+        for (int i = 0; i < removed_count; i++) {
+            advertised[tc->selector_count + i] = tc->removed_selectors[i].neighbor_addr;
+        }
         
-        // Add to global topology database
-        if (add_topology_link(msg->originator, selector, tc->ansn, validity) == 0) {
+        int changes;
+        if (is_delta) {
+            // Apply on top of the stored set if it is exactly at base_ansn
+            changes = apply_topology_delta(msg->originator, tc->base_ansn, tc->ansn,
+                                           advertised, tc->selector_count,
+                                           advertised + tc->selector_count, removed_count,
+                                           validity);
+            if (changes < 0) {
+                printf("TC_PROCESS: No set at ANSN %d for %s - waiting for a full TC\n",
+                       tc->base_ansn, orig_str);
+            }
+        } else {
+            // Replace the originator's advertised set unless this ANSN is stale
+            changes = update_topology_set(msg->originator, tc->ansn, advertised,
+                                          tc->selector_count, validity);
+        }
+        if (changes > 0) {
             topology_updated = 1;
         }
-        
-        // Also update old routing topology (for compatibility)
-        update_tc_topology(msg->originator, selector, validity);
+        free(advertised);
     }
     
     // Step 4: Update routing table if topology changed
+    // New links were already applied to the shortest path tree incrementally
     if (topology_updated) {
-        printf("TC_PROCESS: Topology updated - recalculating routes\n");
-        update_routing_table();
+        printf("TC_PROCESS: Topology updated - refreshing routes\n");
+        refresh_routing_table();
     }
     
     // Step 5: Message Forwarding (MPR flooding)
@@ -120,15 +186,40 @@ void process_tc_message(struct olsr_message* msg, uint32_t sender_addr) {
 
 // MPR selector management is now handled through neighbor_table[].is_mpr_selector flags
 
+/**
+ * @brief Grow a selector buffer to hold at least count entries
+ * @return 0 on success, -1 on allocation failure
+ */
+static int reserve_selectors(struct tc_neighbor** buffer, int* capacity, int count) {
+    if (count <= *capacity) {
+        return 0;
+    }
+    int new_capacity = *capacity > 0 ? *capacity : MAX_NEIGHBORS;
+    while (new_capacity < count) {
+        new_capacity *= 2;
+    }
+    struct tc_neighbor* grown = (struct tc_neighbor*)realloc(
+        *buffer, (size_t)new_capacity * sizeof(struct tc_neighbor));
+    if (!grown) {
+        return -1;
+    }
+    *buffer = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
 /**
  * @brief Generate a TC message
  * 
  * Creates a TC message structure containing MPR selector information.
+ * The selector set is compared against the one found by the previous
+ * call; the ANSN is only incremented if it changed, and the added and
+ * withdrawn selectors are kept as a delta TC for send_tc_message().
  * NOTE: this implementation uses static storage for the returned message
  * and for the MPR selector list. The returned pointer points into static
  * buffers which are overwritten on each call and must NOT be freed by caller.
  *
- * @return Pointer to a statically allocated TC message (never NULL)
+ * @return Pointer to a statically allocated full TC message (never NULL)
  * 
  * @note The returned pointer and MPR selector list have static lifetime
  *       (valid until the next call to this function). This is intentional
@@ -136,35 +227,85 @@ void process_tc_message(struct olsr_message* msg, uint32_t sender_addr) {
  *       NOT thread-safe: concurrent calls will overwrite the same buffers.
  */
 struct olsr_tc* generate_tc_message(void) {
-    static struct olsr_tc tc_msg;
-    static struct tc_neighbor mpr_selectors_static[MAX_NEIGHBORS];
+    int previous = tc_current;
+    int current = tc_current ^ 1;
     
-    // Clear the message
-    memset(&tc_msg, 0, sizeof(struct olsr_tc));
-    memset(mpr_selectors_static, 0, sizeof(mpr_selectors_static));
+    // Every selector is a neighbor, so size the buffers to the neighbor table
+    int tracked = (reserve_selectors(&tc_lists[current], &tc_list_capacity[current], neighbor_count) == 0 &&
+                   reserve_selectors(&tc_added, &tc_added_capacity, neighbor_count) == 0 &&
+                   reserve_selectors(&tc_removed, &tc_removed_capacity, tc_list_count[previous]) == 0);
+    int needed = get_interned_node_count() + neighbor_count;
+    if (tracked && needed > tc_listed_capacity) {
+        uint32_t* grown = (uint32_t*)realloc(tc_listed, (size_t)needed * sizeof(uint32_t));
+        if (grown) {
+            memset(grown + tc_listed_capacity, 0, (size_t)(needed - tc_listed_capacity) * sizeof(uint32_t));
+            tc_listed = grown;
+            tc_listed_capacity = needed;
+        } else {
+            tracked = 0;
+        }
+    }
+    if (!tracked) {
+        printf("Error: Failed to grow TC buffers\n");
+        return &tc_full;  // Advertise the previous set again
+    }
+    uint32_t generation = ++tc_generation;
     
-    // Count neighbors who selected us as MPR
+    // Collect neighbors who selected us as MPR, noting the new ones
     int selector_count = 0;
-    for (int i = 0; i < neighbor_count && selector_count < MAX_NEIGHBORS; i++) {
+    int added_count = 0;
+    for (int i = 0; i < neighbor_count; i++) {
         if (neighbor_table[i].link_status == SYM_LINK &&
             neighbor_table[i].is_mpr_selector) {
-            mpr_selectors_static[selector_count].neighbor_addr = neighbor_table[i].neighbor_id;
-            selector_count++;
+            uint32_t selector = neighbor_table[i].neighbor_id;
+            int index = intern_node(selector);
+            if (index < 0 || index >= tc_listed_capacity) {
+                continue;
+            }
+            if (tc_listed[index] != generation - 1) {
+                tc_added[added_count++].neighbor_addr = selector;
+            }
+            tc_listed[index] = generation;
+            tc_lists[current][selector_count++].neighbor_addr = selector;
             
             char selector_str[16];
-            printf("  Including MPR selector: %s\n",
-                   id_to_string(neighbor_table[i].neighbor_id, selector_str));
+            printf("  Including MPR selector: %s\n", id_to_string(selector, selector_str));
         }
     }
     
-    tc_msg.ansn = ++ansn_counter;
-    tc_msg.selector_count = selector_count;
-    tc_msg.mpr_selectors = (selector_count > 0) ? mpr_selectors_static : NULL;
+    // Selectors of the previous call that were not listed again were withdrawn
+    int removed_count = 0;
+    for (int i = 0; i < tc_list_count[previous]; i++) {
+        uint32_t selector = tc_lists[previous][i].neighbor_addr;
+        if (tc_listed[lookup_node_index(selector)] != generation) {
+            tc_removed[removed_count++].neighbor_addr = selector;
+        }
+    }
+    tc_list_count[current] = selector_count;
+    tc_current = current;
+    
+    if (added_count > 0 || removed_count > 0) {
+        tc_delta.tc_type = TC_DELTA;
+        tc_delta.base_ansn = ansn_counter;
+        tc_delta.ansn = ++ansn_counter;
+        tc_delta.mpr_selectors = added_count > 0 ? tc_added : NULL;
+        tc_delta.selector_count = added_count;
+        tc_delta.removed_selectors = removed_count > 0 ? tc_removed : NULL;
+        tc_delta.removed_count = removed_count;
+    }
     
-    printf("Generated TC message: ANSN=%d, MPR selectors=%d\n", 
-           tc_msg.ansn, tc_msg.selector_count);
+    tc_full.ansn = ansn_counter;
+    tc_full.tc_type = TC_FULL;
+    tc_full.base_ansn = 0;
+    tc_full.selector_count = selector_count;
+    tc_full.mpr_selectors = (selector_count > 0) ? tc_lists[current] : NULL;
+    tc_full.removed_selectors = NULL;
+    tc_full.removed_count = 0;
     
-    return &tc_msg;
+    printf("Generated TC message: ANSN=%d, MPR selectors=%d (%d added, %d removed)\n", 
+           tc_full.ansn, tc_full.selector_count, added_count, removed_count);
+    
+    return &tc_full;
 }
 
 /**
@@ -174,9 +315,14 @@ struct olsr_tc* generate_tc_message(void) {
  * and queues it for transmission. This function handles message creation,
  * sequence number assignment, and logging.
  * 
- * @param queue Pointer to the control queue for RRC/TDMA layer transmission
+ * A TC is only flooded when the ANSN changed since the last TC sent, or
+ * when a non-empty set has not been advertised for TC_REFRESH_INTERVAL,
+ * so receivers' topology entries never come close to TC_VALIDITY_TIME.
+ * Changes are sent as a delta against the last TC sent when that is
+ * smaller than the full set, but at least every TC_FULL_INTERVAL a full
+ * TC resynchronises nodes that missed a delta.
  * 
- * @note TC messages are only sent if there are MPR selectors to advertise
+ * @param queue Pointer to the control queue for RRC/TDMA layer transmission
  */
 void send_tc_message(struct control_queue* queue) {
     if (!queue) {
@@ -184,25 +330,31 @@ void send_tc_message(struct control_queue* queue) {
         return;
     }
     
-    // Count MPR selectors first
-    int mpr_selector_count = get_mpr_selector_count();
-    
-    // Only send if we have MPR selectors
-    if (mpr_selector_count == 0) {
-        printf("No MPR selectors - skipping TC message\n");
-        return;
-    }
-    
     struct olsr_tc* tc_msg = generate_tc_message();
-    if (!tc_msg) {
-        printf("Error: Failed to generate TC message\n");
-        return;
+    olsr_time_t now = olsr_clock_now();
+    int changed = tc_sent ? (tc_msg->ansn != tc_sent_ansn) : (tc_msg->selector_count > 0);
+    
+    if (!changed) {
+        if (tc_msg->selector_count == 0) {
+            printf("No MPR selectors - skipping TC message\n");
+            return;
+        }
+        if (now - tc_sent_time < TC_REFRESH_INTERVAL) {
+            printf("MPR selectors unchanged (ANSN=%d) - suppressing TC message\n", tc_msg->ansn);
+            return;
+        }
+    } else if (tc_sent && now - tc_full_sent_time < TC_FULL_INTERVAL &&
+               tc_delta.ansn == tc_msg->ansn &&
+               tc_delta.base_ansn == tc_sent_ansn &&  // No unsent change in between
+               !control_queue_has_pending(queue, CONTROL_KEY_TC) &&  // Base not about to be replaced
+               tc_delta.selector_count + tc_delta.removed_count < tc_msg->selector_count) {
+        tc_msg = &tc_delta;
     }
 
     // Create proper OLSR message header with full sequencing
     struct olsr_message hdr;
     hdr.msg_type = MSG_TC;
-    hdr.vtime = TC_VALIDITY_TIME;  // Use constant for consistency
+    hdr.vtime = TC_VALIDITY_TIME / OLSR_MSEC_PER_SEC;  // Wire format is whole seconds
     hdr.originator = node_id;
     hdr.ttl = 255;                 // Maximum TTL for network-wide flooding
     hdr.hop_count = 0;             // This is the originating node
@@ -212,16 +364,23 @@ void send_tc_message(struct control_queue* queue) {
 
     printf("\n=== GENERATING TC MESSAGE ===\n");
     printf("Originator: 0x%08X, SeqNum: %d, TTL: %d\n", hdr.originator, hdr.msg_seq_num, hdr.ttl);
-    printf("ANSN: %d, MPR Selectors: %d, Validity: %ds\n", 
-           tc_msg->ansn, tc_msg->selector_count, hdr.vtime);
+    if (tc_msg->tc_type == TC_DELTA) {
+        printf("ANSN: %d (delta from %d), Added: %d, Removed: %d, Validity: %ds\n",
+               tc_msg->ansn, tc_msg->base_ansn, tc_msg->selector_count,
+               tc_msg->removed_count, hdr.vtime);
+    } else {
+        printf("ANSN: %d, MPR Selectors: %d, Validity: %ds\n", 
+               tc_msg->ansn, tc_msg->selector_count, hdr.vtime);
+    }
     
     // Add to our own duplicate table to prevent processing our own message
     add_duplicate_entry(hdr.originator, hdr.msg_seq_num);
 
-    // Push pointer to the TC structure directly to the queue
-    // RRC/TDMA layer will handle serialization
-    int result = push_to_control_queue(queue, MSG_TC, (void*)tc_msg);
+    // Push pointer to the TC structure directly to the queue, replacing any
+    // TC of ours still waiting there. RRC/TDMA layer will handle serialization
+    int result = push_keyed_message(queue, MSG_TC, (void*)tc_msg, CONTROL_CLASS_TC, CONTROL_KEY_TC);
     if (result == 0) {
+        // The base for the next delta is recorded once this is transmitted
         printf("TC Message successfully queued for RRC/TDMA Layer\n");
     } else {
         printf("ERROR: Failed to queue TC Message (code=%d)\n", result);
@@ -229,6 +388,29 @@ void send_tc_message(struct control_queue* queue) {
     }
 }
 
+void tc_message_transmitted(const struct olsr_tc* msg) {
+    // Forwarded TCs share the message type; only our own TC is a delta base
+    if (msg != &tc_full && msg != &tc_delta) {
+        return;
+    }
+    olsr_time_t now = olsr_clock_now();
+    tc_sent = 1;
+    tc_sent_ansn = msg->ansn;
+    tc_sent_time = now;
+    if (msg->tc_type == TC_FULL) {
+        tc_full_sent_time = now;
+    }
+}
+
+void request_tc_message(void) {
+    __atomic_store_n(&tc_requested, 1, __ATOMIC_RELEASE);
+    event_loop_wake();
+}
+
+int take_tc_request(void) {
+    return __atomic_exchange_n(&tc_requested, 0, __ATOMIC_ACQ_REL);
+}
+
 // get_mpr_selector_count() is now implemented in hello.c
 
 /**
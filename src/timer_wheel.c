@@ -0,0 +1,413 @@
+/**
+ * @file timer_wheel.c
+ * @brief Hierarchical timing wheel implementation
+ * @author OLSR Implementation Team
+ * @date 2026-10-16
+ *
+ * Timers live in a growable pool and are addressed by index. Each wheel
+ * level has 64 slots, each a doubly linked list of timers, plus a 64-bit
+ * occupancy mask so empty stretches are skipped without visiting slots.
+ * Ticks are olsr_clock milliseconds, so level l slots span 64^l ms and
+ * the six levels cover about two years. When the wheel enters a new level-l
+ * block the matching slot is cascaded down to the finer levels.
+ *
+ * A (callback, key) hash lets callers re-arm a timer without holding a
+ * handle, so table entries that move around in memory need no back
+ * pointers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../include/timer_wheel.h"
+#include "../include/olsr_clock.h"
+
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS 6
+#define DUE_LEVEL WHEEL_LEVELS  /**< Pseudo-level holding timers armed in the past */
+
+/**
+ * @brief Timer pool entry
+ */
+struct wheel_timer {
+    timer_callback callback; /**< Expiry callback (NULL = free entry) */
+    uint32_t key;            /**< Key passed to the callback */
+    uint64_t expires;        /**< Absolute expiry tick */
+    int level;               /**< Wheel level, or -1 if not armed */
+    int slot;                /**< Slot within the level */
+    int prev;                /**< Previous timer in the slot list */
+    int next;                /**< Next timer in the slot list, or free list link */
+    int hash_next;           /**< Next timer in the hash chain */
+};
+
+/** @brief Timer pool */
+static struct wheel_timer* timers = NULL;
+/** @brief Allocated entries in the pool */
+static int timer_capacity = 0;
+/** @brief Head of the free list */
+static int free_head = -1;
+/** @brief Number of armed timers */
+static int armed_count = 0;
+
+/** @brief Slot list heads per level, plus the due list */
+static int slot_head[WHEEL_LEVELS + 1][WHEEL_SLOTS];
+/** @brief Occupied slots per level, plus the due list */
+static uint64_t occupied[WHEEL_LEVELS + 1];
+/** @brief Next tick to be processed (ticks before it have fired) */
+static uint64_t wheel_next = 0;
+/** @brief Set once the slot heads are initialised */
+static int wheel_initialized = 0;
+
+/** @brief (callback, key) hash chains */
+static int* hash_head = NULL;
+/** @brief Number of hash chains (power of two) */
+static int hash_capacity = 0;
+
+/**
+ * @brief Current wheel time in ticks
+ */
+static uint64_t wheel_clock(void) {
+    return (uint64_t)olsr_clock_now();
+}
+
+/**
+ * @brief Hash a (callback, key) pair to its chain
+ */
+static unsigned int hash_timer(timer_callback callback, uint32_t key) {
+    uintptr_t cb = (uintptr_t)callback;
+    uint32_t h = key * 2654435761u ^ (uint32_t)(cb >> 4) * 2246822519u;
+    return (h ^ (h >> 15)) & (unsigned int)(hash_capacity - 1);
+}
+
+/**
+ * @brief Initialise empty slot lists
+ */
+static void wheel_init(void) {
+    for (int l = 0; l <= WHEEL_LEVELS; l++) {
+        for (int s = 0; s < WHEEL_SLOTS; s++) {
+            slot_head[l][s] = -1;
+        }
+        occupied[l] = 0;
+    }
+    wheel_initialized = 1;
+}
+
+/**
+ * @brief Double the pool and rehash
+ * @return 0 on success, -1 on allocation failure
+ */
+static int grow_pool(void) {
+    int capacity = timer_capacity > 0 ? 2 * timer_capacity : 64;
+
+    struct wheel_timer* grown = (struct wheel_timer*)realloc(
+        timers, (size_t)capacity * sizeof(struct wheel_timer));
+    if (!grown) {
+        return -1;
+    }
+    timers = grown;
+
+    int* heads = (int*)malloc((size_t)capacity * sizeof(int));
+    if (!heads) {
+        return -1;
+    }
+    free(hash_head);
+    hash_head = heads;
+    hash_capacity = capacity;
+    memset(hash_head, -1, (size_t)hash_capacity * sizeof(int));
+
+    for (int i = 0; i < timer_capacity; i++) {
+        if (timers[i].callback) {
+            unsigned int h = hash_timer(timers[i].callback, timers[i].key);
+            timers[i].hash_next = hash_head[h];
+            hash_head[h] = i;
+        }
+    }
+    for (int i = capacity - 1; i >= timer_capacity; i--) {
+        timers[i].callback = NULL;
+        timers[i].level = -1;
+        timers[i].next = free_head;
+        free_head = i;
+    }
+    timer_capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Find the pool entry of a (callback, key) pair
+ * @return Pool index, or -1 if there is none
+ */
+static int find_timer(timer_callback callback, uint32_t key) {
+    if (hash_capacity == 0) {
+        return -1;
+    }
+    for (int i = hash_head[hash_timer(callback, key)]; i != -1; i = timers[i].hash_next) {
+        if (timers[i].callback == callback && timers[i].key == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Put a timer into the slot matching its expiry
+ */
+static void wheel_insert(int t) {
+    struct wheel_timer* timer = &timers[t];
+    uint64_t expires = timer->expires;
+    int level = DUE_LEVEL;
+    int slot = 0;
+
+    // Ticks before wheel_next have already been processed, so a timer
+    // armed in the past goes on the due list for the next run
+    if (expires >= wheel_next) {
+        // Lowest level at which expiry and now fall in the same parent block
+        level = 0;
+        while (level < WHEEL_LEVELS - 1 &&
+               (expires >> (WHEEL_BITS * (level + 1))) != (wheel_next >> (WHEEL_BITS * (level + 1)))) {
+            level++;
+        }
+        slot = (int)((expires >> (WHEEL_BITS * level)) & WHEEL_MASK);
+    }
+
+    timer->level = level;
+    timer->slot = slot;
+    timer->prev = -1;
+    timer->next = slot_head[level][slot];
+    if (timer->next != -1) {
+        timers[timer->next].prev = t;
+    }
+    slot_head[level][slot] = t;
+    occupied[level] |= (uint64_t)1 << slot;
+    armed_count++;
+}
+
+/**
+ * @brief Take a timer out of its slot
+ */
+static void wheel_remove(int t) {
+    struct wheel_timer* timer = &timers[t];
+    if (timer->level < 0) {
+        return;
+    }
+    if (timer->prev != -1) {
+        timers[timer->prev].next = timer->next;
+    } else {
+        slot_head[timer->level][timer->slot] = timer->next;
+    }
+    if (timer->next != -1) {
+        timers[timer->next].prev = timer->prev;
+    }
+    if (slot_head[timer->level][timer->slot] == -1) {
+        occupied[timer->level] &= ~((uint64_t)1 << timer->slot);
+    }
+    timer->level = -1;
+    armed_count--;
+}
+
+/**
+ * @brief Return a disarmed timer to the free list
+ */
+static void release_timer(int t) {
+    unsigned int h = hash_timer(timers[t].callback, timers[t].key);
+    int* link = &hash_head[h];
+    while (*link != t) {
+        link = &timers[*link].hash_next;
+    }
+    *link = timers[t].hash_next;
+
+    timers[t].callback = NULL;
+    timers[t].next = free_head;
+    free_head = t;
+}
+
+/**
+ * @brief Fire every timer of a slot list, re-inserting any not yet due
+ * @return Number of timers fired
+ */
+static int fire_slot(int level, int slot, uint64_t tick) {
+    int fired = 0;
+    while (slot_head[level][slot] != -1) {
+        int t = slot_head[level][slot];
+        wheel_remove(t);
+        if (timers[t].expires > tick) {
+            wheel_insert(t);  // Clamped beyond the top level, not due yet
+            continue;
+        }
+        timer_callback callback = timers[t].callback;
+        uint32_t key = timers[t].key;
+        release_timer(t);
+        callback(key);
+        fired++;
+    }
+    return fired;
+}
+
+/**
+ * @brief Re-insert every timer of a coarse slot at the finer levels
+ */
+static void wheel_cascade(int level, int slot) {
+    int t = slot_head[level][slot];
+    slot_head[level][slot] = -1;
+    occupied[level] &= ~((uint64_t)1 << slot);
+
+    while (t != -1) {
+        int next = timers[t].next;
+        armed_count--;
+        wheel_insert(t);
+        t = next;
+    }
+}
+
+int timer_wheel_schedule(timer_callback callback, uint32_t key, olsr_time_t expires) {
+    if (!callback) {
+        return -1;
+    }
+    if (!wheel_initialized) {
+        wheel_init();
+    }
+    if (armed_count == 0) {
+        wheel_next = wheel_clock();  // Idle wheel: skip straight to now
+    }
+
+    int t = find_timer(callback, key);
+    if (t == -1) {
+        if (free_head == -1 && grow_pool() != 0) {
+            printf("Error: Failed to grow timer pool\n");
+            return -1;
+        }
+        t = free_head;
+        free_head = timers[t].next;
+        timers[t].callback = callback;
+        timers[t].key = key;
+        timers[t].level = -1;
+        unsigned int h = hash_timer(callback, key);
+        timers[t].hash_next = hash_head[h];
+        hash_head[h] = t;
+    } else {
+        wheel_remove(t);
+    }
+
+    timers[t].expires = expires > 0 ? (uint64_t)expires : 0;
+    wheel_insert(t);
+    return 0;
+}
+
+void timer_wheel_cancel(timer_callback callback, uint32_t key) {
+    int t = find_timer(callback, key);
+    if (t != -1) {
+        wheel_remove(t);
+        release_timer(t);
+    }
+}
+
+int timer_wheel_run(void) {
+    if (!wheel_initialized) {
+        return 0;  // Nothing was ever scheduled
+    }
+    uint64_t now = wheel_clock();
+
+    // Timers armed in the past; ones they arm in the past wait for the next run
+    int due = slot_head[DUE_LEVEL][0];
+    slot_head[DUE_LEVEL][0] = -1;
+    occupied[DUE_LEVEL] = 0;
+    int fired = 0;
+    while (due != -1) {
+        int t = due;
+        due = timers[t].next;
+        timers[t].level = -1;
+        armed_count--;
+        timer_callback callback = timers[t].callback;
+        uint32_t key = timers[t].key;
+        release_timer(t);
+        callback(key);
+        fired++;
+    }
+
+    while (armed_count > 0 && wheel_next <= now) {
+        uint64_t tick = wheel_next;
+
+        // Entering a new block at some level: cascade coarsest first
+        if ((tick & WHEEL_MASK) == 0) {
+            int top = 1;
+            while (top < WHEEL_LEVELS - 1 &&
+                   (tick & (((uint64_t)1 << (WHEEL_BITS * (top + 1))) - 1)) == 0) {
+                top++;
+            }
+            for (int l = top; l >= 1; l--) {
+                int slot = (int)((tick >> (WHEEL_BITS * l)) & WHEEL_MASK);
+                if (occupied[l] & ((uint64_t)1 << slot)) {
+                    wheel_cascade(l, slot);
+                }
+            }
+        }
+
+        // Fire the level-0 slot of this tick
+        fired += fire_slot(0, (int)(tick & WHEEL_MASK), tick);
+        wheel_next = tick + 1;
+
+        // Skip the empty rest of this level-0 block
+        int pos = (int)(wheel_next & WHEEL_MASK);
+        if (pos != 0 && (occupied[0] >> pos) == 0) {
+            uint64_t block_end = (wheel_next | WHEEL_MASK) + 1;
+            wheel_next = block_end <= now + 1 ? block_end : now + 1;
+        }
+    }
+
+    if (armed_count == 0 && wheel_next <= now) {
+        wheel_next = now + 1;
+    }
+    return fired;
+}
+
+int timer_wheel_next_expiry(olsr_time_t* next) {
+    if (armed_count == 0) {
+        return 0;
+    }
+    if (occupied[DUE_LEVEL]) {
+        *next = (olsr_time_t)(wheel_next - 1);  // Already overdue
+        return 1;
+    }
+
+    // Sitting on a block boundary whose coarse slot is not cascaded yet
+    for (int l = 1; l < WHEEL_LEVELS; l++) {
+        uint64_t span = (uint64_t)1 << (WHEEL_BITS * l);
+        int pos = (int)((wheel_next >> (WHEEL_BITS * l)) & WHEEL_MASK);
+        if ((wheel_next & (span - 1)) != 0) {
+            break;
+        }
+        if (occupied[l] & ((uint64_t)1 << pos)) {
+            *next = (olsr_time_t)wheel_next;
+            return 1;
+        }
+    }
+
+    for (int l = 0; l < WHEEL_LEVELS; l++) {
+        if (!occupied[l]) {
+            continue;
+        }
+        // Slots at or after the current position in this level's block
+        int pos = (int)((wheel_next >> (WHEEL_BITS * l)) & WHEEL_MASK);
+        uint64_t ahead = occupied[l] >> pos;
+        uint64_t span = (uint64_t)1 << (WHEEL_BITS * l);
+        if (l > 0) {
+            ahead &= ~(uint64_t)1;  // The current block was cascaded on entry
+        }
+        if (!ahead) {
+            continue;
+        }
+        int offset = __builtin_ctzll(ahead);
+        uint64_t start = ((wheel_next >> (WHEEL_BITS * l)) + (uint64_t)offset) * span;
+        *next = (olsr_time_t)(start > wheel_next ? start : wheel_next);
+        return 1;
+    }
+
+    *next = (olsr_time_t)wheel_next;  // Only clamped far-future timers remain
+    return 1;
+}
+
+int timer_wheel_count(void) {
+    return armed_count;
+}